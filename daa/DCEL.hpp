@@ -7,25 +7,42 @@
 #define DCEL_H
 
 #include <bits/stdc++.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "Vertex.hpp"
 #include "Face.hpp"
 #include "Edge.hpp"
+#include "SmallPolygon.hpp"
 using namespace std;
 /**
  * @brief Output file stream for writing the output of the split algorithm.
+ * The file is only created once something is written to it, so including this header does no file I/O.
  * 
  */
-ofstream fout("output.txt");
+ofstream& fout_file()
+{
+    static ofstream fout("output.txt");
+    return fout;
+}
 /**
- * @brief Output file stream for writing the polygon vertices.
+ * @brief Output file stream for writing the polygon vertices, created on first use.
  * 
  */
-ofstream poly("polygon.txt");
+ofstream& poly_file()
+{
+    static ofstream poly("polygon.txt");
+    return poly;
+}
 /**
- * @brief Output file stream for writing the output of the merge algorithm.
+ * @brief Output file stream for writing the output of the merge algorithm, created on first use.
  * 
  */
-ofstream merg("merge.txt");
+ofstream& merg_file()
+{
+    static ofstream merg("merge.txt");
+    return merg;
+}
 
 class Vertex;
 class Face;
@@ -81,53 +98,204 @@ bool lieonsameside(Vertex *v1, Vertex *v2, Vertex *v3, Vertex *v4)
     }
     return false;
 }
+/**
+ * @brief Check if three vertices lie on one line.
+ *
+ * @param A The first vertex
+ * @param B The second vertex
+ * @param C The third vertex
+ * @return true if they are exactly collinear, also when two of them coincide.
+ * @return false otherwise.
+ */
+bool iscollinear(Vertex *A, Vertex *B, Vertex *C)
+{
+    return (B->x - A->x) * (C->y - A->y) - (C->x - A->x) * (B->y - A->y) == 0;
+}
+/**
+ * @brief Check if a vertex lies on the segment between two others, strictly between its ends.
+ *
+ * @param v The vertex
+ * @param a The first end of the segment
+ * @param b The second end of the segment
+ * @return true if v lies on the segment and on neither end.
+ * @return false otherwise.
+ */
+bool liesbetween(Vertex *v, Vertex *a, Vertex *b)
+{
+    double x1 = b->x - a->x;
+    double y1 = b->y - a->y;
+    double x2 = v->x - a->x;
+    double y2 = v->y - a->y;
+    double dot = x1 * x2 + y1 * y2;
+    return x1 * y2 - x2 * y1 == 0 && dot > 0 && dot < x1 * x1 + y1 * y1;
+}
+/**
+ * @brief Check if a segment starts into the polygon at a vertex of it.
+ *
+ * @param A The vertex before B on the clockwise boundary.
+ * @param B The vertex the segment starts at.
+ * @param C The vertex after B on the boundary.
+ * @param D The other end of the segment.
+ * @return true if B -> D starts strictly inside the angle A B C of the polygon.
+ * @return false if it starts outside, along one of the two edges, or D lies on B.
+ */
+bool leavesinside(Vertex *A, Vertex *B, Vertex *C, Vertex *D)
+{
+    double ux = A->x - B->x, uy = A->y - B->y;
+    double wx = C->x - B->x, wy = C->y - B->y;
+    double dx = D->x - B->x, dy = D->y - B->y;
+    double wd = wx * dy - wy * dx;
+    double du = dx * uy - dy * ux;
+    if (ux * wy - uy * wx >= 0)
+    {
+        // B is convex: D has to be right of both edges
+        return wd < 0 && du < 0;
+    }
+    return wd < 0 || du < 0;
+}
 /**
  * @brief Returns the previous vertex of a given vertex in a face.
  * 
  * @param f A pointer to the face
  * @param v A pointer to the vertex whose previous vertex is to be found
- * @return A pointer to the previous vertex (Vertex*) 
- */
+ * @return A pointer to the previous vertex (Vertex*), NULL if v is not on the face
+ */
 Vertex* prev_vertex(Face* f,Vertex* v)
 {
-    Vertex* res;
-    Edge* e = f->inc_edge;
-    Edge* e1 = e;
-    do{
-        e1 = e1->prev;
-        if(e1 ->org == v){
-            e1 = e1->prev;
-            res = e1->org;
-            return res;
-        }
-    }
-    while(e1 != e);
-    return res;
-
+    Edge* e = v->outgoing(f);
+    return e ? e->prev->org : NULL;
 }
 /**
  * @brief Returns the next vertex of a given vertex in a given face.
  * 
  * @param f pointer to the face in which the next vertex is to be found.
  * @param v pointer to the vertex whose next vertex is to be found.
- * @return A pointer to the next vertex (Vertex*)  
- */
+ * @return A pointer to the next vertex (Vertex*), NULL if v is not on the face
+ */
 Vertex* next_vertex(Face* f,Vertex* v)
 {
-    Vertex* res;
-    Edge* e = f->inc_edge;
-    Edge* e1 = e;
-    do{
-        e1 = e1->next;
-        if(e1 ->org == v){
-            e1 = e1->next;
-            res = e1->org;
-            return res;
+    Edge* e = v->outgoing(f);
+    return e ? e->next->org : NULL;
+}
+/**
+ * @brief Twice the signed area of a polygon (shoelace formula): negative for a clockwise polygon.
+ * Uses AVX2 when compiled with it, four independent sums otherwise, so it runs at memory speed.
+ * 
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @param n no of vertices
+ * @return twice the signed area
+ */
+double signed_area(const double* xs, const double* ys, int n)
+{
+    if (n < 3)
+    {
+        return 0;
+    }
+    int i = 0;
+    double sum = 0;
+#ifdef __AVX2__
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 < n; i += 4)
+    {
+        __m256d x0 = _mm256_loadu_pd(xs + i), y0 = _mm256_loadu_pd(ys + i);
+        __m256d x1 = _mm256_loadu_pd(xs + i + 1), y1 = _mm256_loadu_pd(ys + i + 1);
+        acc = _mm256_add_pd(acc, _mm256_sub_pd(_mm256_mul_pd(x0, y1), _mm256_mul_pd(x1, y0)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 < n; i += 4)
+    {
+        s0 += xs[i] * ys[i + 1] - xs[i + 1] * ys[i];
+        s1 += xs[i + 1] * ys[i + 2] - xs[i + 2] * ys[i + 1];
+        s2 += xs[i + 2] * ys[i + 3] - xs[i + 3] * ys[i + 2];
+        s3 += xs[i + 3] * ys[i + 4] - xs[i + 4] * ys[i + 3];
+    }
+    sum = (s0 + s1) + (s2 + s3);
+#endif
+    for (; i < n; i++)
+    {
+        int j = i + 1 == n ? 0 : i + 1;
+        sum += xs[i] * ys[j] - xs[j] * ys[i];
+    }
+    return sum;
+}
+/**
+ * @brief Area, centroid and bounding box of a closed ring in one pass: the shoelace sums of the area and of
+ * the centroid and the running minima and maxima, four edges at a time with AVX2 when compiled with it.
+ * Coordinates are taken relative to the first vertex so that the centroid keeps its precision far from the
+ * origin.
+ *
+ * @param xs x-coordinates of the k vertices followed by the first one again
+ * @param ys y-coordinates, laid out the same way
+ * @param k no of vertices
+ * @param out receives area (unsigned), centroid x and y, min x, min y, max x, max y
+ */
+void ring_attributes(const double* xs, const double* ys, int k, double out[7])
+{
+    double x0 = xs[0], y0 = ys[0];
+    double a = 0, sx = 0, sy = 0, lox = x0, loy = y0, hix = x0, hiy = y0;
+    int i = 0;
+#ifdef __AVX2__
+    if (k >= 4)
+    {
+        __m256d ox = _mm256_set1_pd(x0), oy = _mm256_set1_pd(y0);
+        __m256d acc = _mm256_setzero_pd(), accx = acc, accy = acc;
+        __m256d mnx = ox, mny = oy, mxx = ox, mxy = oy;
+        for (; i + 4 <= k; i += 4)
+        {
+            __m256d px = _mm256_loadu_pd(xs + i), py = _mm256_loadu_pd(ys + i);
+            __m256d ax = _mm256_sub_pd(px, ox), ay = _mm256_sub_pd(py, oy);
+            __m256d bx = _mm256_sub_pd(_mm256_loadu_pd(xs + i + 1), ox), by = _mm256_sub_pd(_mm256_loadu_pd(ys + i + 1), oy);
+            __m256d c = _mm256_sub_pd(_mm256_mul_pd(ax, by), _mm256_mul_pd(bx, ay));
+            acc = _mm256_add_pd(acc, c);
+            accx = _mm256_add_pd(accx, _mm256_mul_pd(_mm256_add_pd(ax, bx), c));
+            accy = _mm256_add_pd(accy, _mm256_mul_pd(_mm256_add_pd(ay, by), c));
+            mnx = _mm256_min_pd(mnx, px);
+            mny = _mm256_min_pd(mny, py);
+            mxx = _mm256_max_pd(mxx, px);
+            mxy = _mm256_max_pd(mxy, py);
         }
+        double l[4][4];
+        _mm256_storeu_pd(l[0], acc);
+        _mm256_storeu_pd(l[1], accx);
+        _mm256_storeu_pd(l[2], accy);
+        _mm256_storeu_pd(l[3], mnx);
+        a = (l[0][0] + l[0][1]) + (l[0][2] + l[0][3]);
+        sx = (l[1][0] + l[1][1]) + (l[1][2] + l[1][3]);
+        sy = (l[2][0] + l[2][1]) + (l[2][2] + l[2][3]);
+        lox = min(min(l[3][0], l[3][1]), min(l[3][2], l[3][3]));
+        _mm256_storeu_pd(l[3], mny);
+        loy = min(min(l[3][0], l[3][1]), min(l[3][2], l[3][3]));
+        _mm256_storeu_pd(l[3], mxx);
+        hix = max(max(l[3][0], l[3][1]), max(l[3][2], l[3][3]));
+        _mm256_storeu_pd(l[3], mxy);
+        hiy = max(max(l[3][0], l[3][1]), max(l[3][2], l[3][3]));
     }
-    while(e1 != e);
-    return res;
-
+#endif
+    for (; i < k; i++)
+    {
+        double ax = xs[i] - x0, ay = ys[i] - y0, bx = xs[i + 1] - x0, by = ys[i + 1] - y0;
+        double c = ax * by - bx * ay;
+        a += c;
+        sx += (ax + bx) * c;
+        sy += (ay + by) * c;
+        lox = min(lox, xs[i]);
+        loy = min(loy, ys[i]);
+        hix = max(hix, xs[i]);
+        hiy = max(hiy, ys[i]);
+    }
+    out[0] = fabs(a) / 2;
+    // a degenerate ring has no centroid of its area, the middle of its box stands in
+    out[1] = a != 0 ? x0 + sx / (3 * a) : (lox + hix) / 2;
+    out[2] = a != 0 ? y0 + sy / (3 * a) : (loy + hiy) / 2;
+    out[3] = lox;
+    out[4] = loy;
+    out[5] = hix;
+    out[6] = hiy;
 }
 /**
  * @brief An implementation of a doubly-connected edge list (DCEL) data structure.
@@ -142,14 +310,50 @@ public:
     vector<Edge*> twin_edges;
     vector<Face *> faces;
     vector<Edge*>LLE;
+    vector<int> input_id; // input_id[i] is the index in the input of vertex i, empty when they are the same
+    bool use_small_path;
+    bool verbose; // report the end of split() and merge() on cout
+    double lpv_ms, merge_loop_ms; // milliseconds the last merge() spent building LPV and in its main loop
+    double split_budget_ms;       // time split() may spend on MP1 before clipping ears, 0 for no limit
+    long long split_budget_iterations; // iterations of MP1 split() may run, 0 for no limit
+    bool budget_hit;              // whether the last split() ran out of its budget
+    int split_start;              // vertex MP1 starts from, 0 by default
+    // attributes of the faces after compact(), one column each, entry k for faces[k]
+    vector<double> face_area, face_cx, face_cy, face_minx, face_miny, face_maxx, face_maxy;
+    long long split_iterations;   // iterations of MP1 in the last split(), 0 on the small polygon path
+    long long split_failed;       // of those, the ones that added no diagonal and only rotated P
+    long long split_backtracks;   // times steps 3.4.2 and 3.4.3 of the last split() cut L back
     DCEL(int n);
+    ~DCEL();
+    void link_edges();
+    bool build(vector<double>& xs, vector<double>& ys);
+    int source_id(Vertex* v);
     void fout_the_split();
     void fout_the_merge();
+    vector<vector<Vertex*>> convex_faces();
     void summary_faces();
     void split(int n,int& diagonals);
     void merge(int n,int& m);
+    void replay_split(const vector<pair<int,int>>& diags);
+    void replay_merge(const vector<bool>& removed);
     void rotate(Face* f);
     bool isconvex(Vertex* v);
+    void compact();
+
+private:
+    SmallPolygon<SMALL_POLYGON_LIMIT> small;
+    bool small_split;
+    vector<Edge> edge_store; // half-edges and faces after compact(), owned here instead of one by one
+    vector<Face> face_store;
+    bool compacted;
+    vector<Vertex*> lpvs; // LPVS of split() step 3.4, kept between iterations and calls so it is allocated once
+    void face_attributes(const vector<int>& begin);
+    void add_diagonal(Vertex* Front, Vertex* Back);
+    void remove_diagonal(int j);
+    void close_faces(int n);
+    void clip_ears(deque<Vertex*>& P, int& diagonals);
+    bool split_small(int& diagonals);
+    bool merge_small();
     
 };
 /**
@@ -163,20 +367,127 @@ DCEL::DCEL(int n)
     edges.resize(n);
     twin_edges.resize(n);
     faces.resize(0);
+    use_small_path = n >= 3 && n <= SMALL_POLYGON_LIMIT;
+    small_split = false;
+    compacted = false;
+    verbose = true;
+    lpv_ms = merge_loop_ms = 0;
+    split_budget_ms = 0;
+    split_budget_iterations = 0;
+    split_iterations = split_failed = split_backtracks = 0;
+    budget_hit = false;
+    split_start = 0;
 
 }
+/**
+ * @brief Destroy the DCEL::DCEL object along with its vertices, half-edges and faces
+ * 
+ */
+DCEL::~DCEL()
+{
+    for (auto v : this->vertices)
+    {
+        delete v;
+    }
+    if (this->compacted)
+    {
+        return;
+    }
+    for (auto e : this->edges)
+    {
+        delete e;
+    }
+    for (auto e : this->twin_edges)
+    {
+        delete e;
+    }
+    for (auto f : this->faces)
+    {
+        delete f;
+    }
+}
+/**
+ * @brief Creates the boundary half-edges of the polygon once all the vertices are filled in.
+ * edges[i] goes from vertex i to vertex i+1 and twin_edges[i] is its twin.
+ */
+void DCEL::link_edges()
+{
+    int n = this->vertices.size();
+    for (int i = 0; i < n; i++)
+    {
+        Edge *e1 = new Edge(this->vertices[i], NULL, NULL, NULL, NULL);
+        Edge *e2 = new Edge(this->vertices[(i + 1) % n], NULL, NULL, NULL, NULL);
+        e1->twin = e2;
+        e2->twin = e1;
+        this->edges[i] = e1;
+        this->twin_edges[i] = e2;
+        this->vertices[i]->inc_edge = e1;
+        this->vertices[i]->out.assign(1, e1);
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        this->edges[i]->next = this->edges[(i + 1) % n];
+        this->edges[(i + 1) % n]->prev = this->edges[i];
+    }
+}
+/**
+ * @brief Builds the polygon from its coordinates: vertices, boundary half-edges and the winding split() expects.
+ * 
+ * split() walks the polygon clockwise. If the vertices are given counter clockwise, their order is reversed
+ * in place, keeping vertex 0 first as actoc.cpp does, and input_id is updated so the output still refers to
+ * the input order.
+ * 
+ * @param xs x-coordinates of the vertices, reversed if needed
+ * @param ys y-coordinates of the vertices, reversed if needed
+ * @return true if the order was reversed.
+ * @return false otherwise.
+ */
+bool DCEL::build(vector<double>& xs, vector<double>& ys)
+{
+    int n = xs.size();
+    bool reversed = signed_area(xs.data(), ys.data(), n) > 0;
+    if (reversed)
+    {
+        reverse(xs.begin() + 1, xs.end());
+        reverse(ys.begin() + 1, ys.end());
+        if (this->input_id.empty())
+        {
+            this->input_id.resize(n);
+            iota(this->input_id.begin(), this->input_id.end(), 0);
+        }
+        reverse(this->input_id.begin() + 1, this->input_id.end());
+    }
+    for (int i = 0; i < n; i++)
+    {
+        this->vertices[i] = new Vertex(i, xs[i], ys[i], NULL);
+    }
+    this->link_edges();
+    return reversed;
+}
+/**
+ * @brief Gives the index a vertex had in the input, before simplification or reordering.
+ * 
+ * @param v the vertex
+ * @return the index in the input
+ */
+int DCEL::source_id(Vertex* v)
+{
+    return this->input_id.empty() ? v->id : this->input_id[v->id];
+}
 /**
  * @brief Outputs the information of the DCEL to polygon.txt
  * This function prints the information of the vertices and edges in the DCEL to a file stream polygon.txt using script.py script
  */
 void DCEL::fout_the_split()
 {
+    ofstream& fout = fout_file();
+    ofstream& poly = poly_file();
     int n = this->vertices.size();
     fout << "Number of Vertices = " << n << endl;
     fout << "Printing Vertices info\n";
     for (int i = 0; i < n; i++)
     {
-        fout << "Point " << i + 1 << " (" << this->vertices[i]->x << "," << this->vertices[i]->y << ")" << endl;
+        fout << "Point " << this->source_id(this->vertices[i]) + 1 << " (" << this->vertices[i]->x << "," << this->vertices[i]->y << ")" << endl;
     }
  
     int es = this->edges.size();
@@ -185,7 +496,7 @@ void DCEL::fout_the_split()
  
     for (int i = 0; i < es; i++)
     {
-        fout << "Edges between point " << this->edges[i]->org->id << " and " << this->edges[i]->next->org->id << endl;
+        fout << "Edges between point " << this->source_id(this->edges[i]->org) << " and " << this->source_id(this->edges[i]->next->org) << endl;
         poly << this->edges[i]->org->x << " " << this->edges[i]->org->y << " " << this->edges[i]->next->org->x << " " << this->edges[i]->next->org->y;
         if (i != es - 1)
         {
@@ -204,6 +515,7 @@ void DCEL::fout_the_split()
 void DCEL::summary_faces() 
 
 {
+    ofstream& fout = fout_file();
    // cout<<"brdr\n";
 
     fout<<"No of faces are "<<this->faces.size()<<"\n";
@@ -228,6 +540,7 @@ void DCEL::summary_faces()
  */
 void DCEL::fout_the_merge()
 {
+    ofstream& merg = merg_file();
     int cnt = 0;
     // cout<<"ded\n";
     for(auto e:this->edges){
@@ -244,6 +557,261 @@ void DCEL::fout_the_merge()
     }
 
 
+}
+/**
+ * @brief Collects the faces formed by the half-edges still present after merging.
+ * The polygon edges and the diagonals that were kept are walked together with the reversed half-edges of
+ * those diagonals, so every convex piece is returned exactly once.
+ * 
+ * @return the vertices of each face, in the order of Edge::next (the order of the input polygon)
+ */
+vector<vector<Vertex*>> DCEL::convex_faces()
+{
+    int n = this->vertices.size();
+    if (this->compacted)
+    {
+        vector<vector<Vertex*>> res;
+        for (auto f : this->faces)
+        {
+            vector<Vertex*> face;
+            Edge* t = f->inc_edge;
+            do{
+                face.push_back(t->org);
+                t = t->next;
+            }
+            while(t != f->inc_edge);
+            res.push_back(face);
+        }
+        return res;
+    }
+    vector<Edge*> live;
+    for (auto e : this->edges)
+    {
+        if (e->isrequired)
+        {
+            live.push_back(e);
+        }
+    }
+    for (int i = n; i < (int)this->twin_edges.size(); i++)
+    {
+        if (this->twin_edges[i]->twin->isrequired)
+        {
+            live.push_back(this->twin_edges[i]);
+        }
+    }
+    unordered_set<Edge*> seen;
+    vector<vector<Vertex*>> res;
+    for (auto e : live)
+    {
+        if (seen.count(e))
+        {
+            continue;
+        }
+        vector<Vertex*> face;
+        Edge* t = e;
+        do{
+            seen.insert(t);
+            face.push_back(t->org);
+            t = t->next;
+        }
+        while(t != e);
+        res.push_back(face);
+    }
+    return res;
+}
+/**
+ * @brief Rebuilds the DCEL after merge() with only the live half-edges and the merged faces.
+ *
+ * The half-edges removed by merge() are dropped, and so are the faces that were merged into others. The faces are
+ * renumbered 0 .. k-1 in the order convex_faces() returns them, and the half-edges of every face are moved to
+ * one array in the order of Edge::next, face after face, with the outer twins of the boundary at the end.
+ * edges[i] and twin_edges[i] stay the boundary edge i and its twin for i < n, followed by the diagonals that
+ * were kept, in their LLE order; LLE and Vertex::out only hold live half-edges.
+ *
+ * This is the last stage: split() and merge() cannot run on a compacted DCEL. The face_* columns are filled in
+ * (see face_attributes()).
+ */
+void DCEL::compact()
+{
+    int n = this->vertices.size();
+    vector<Edge*> cycles;               // first half-edge of every face
+    vector<Edge*> order;                // live half-edges, face after face
+    unordered_map<Edge*, int> index;
+    auto visit = [&](Edge* e) {
+        if (index.count(e))
+        {
+            return;
+        }
+        cycles.push_back(e);
+        Edge* t = e;
+        do{
+            index[t] = order.size();
+            order.push_back(t);
+            t = t->next;
+        }
+        while(t != e);
+    };
+    for (auto e : this->edges)
+    {
+        if (e->isrequired)
+        {
+            visit(e);
+        }
+    }
+    for (int i = n; i < (int)this->twin_edges.size(); i++)
+    {
+        if (this->twin_edges[i]->twin->isrequired)
+        {
+            visit(this->twin_edges[i]);
+        }
+    }
+    int inner = order.size();
+    for (int i = 0; i < n; i++)
+    {
+        index[this->twin_edges[i]] = order.size();
+        order.push_back(this->twin_edges[i]);
+    }
+
+    vector<Face> fstore;
+    fstore.reserve(cycles.size());
+    for (int k = 0; k < (int)cycles.size(); k++)
+    {
+        fstore.emplace_back((Edge*)NULL, k);
+    }
+    vector<Edge> estore;
+    estore.reserve(order.size());
+    for (auto e : order)
+    {
+        estore.emplace_back(e->org, (Edge*)NULL, (Edge*)NULL, (Edge*)NULL, (Face*)NULL);
+    }
+    auto remap = [&](Edge* e) { return e && index.count(e) ? &estore[index[e]] : (Edge*)NULL; };
+    int k = -1;
+    for (int h = 0; h < (int)order.size(); h++)
+    {
+        Edge* e = order[h];
+        Edge* c = &estore[h];
+        c->twin = remap(e->twin);
+        c->next = remap(e->next);
+        c->prev = remap(e->prev);
+        if (h < inner)
+        {
+            if (k + 1 < (int)cycles.size() && cycles[k + 1] == e)
+            {
+                k++;
+                fstore[k].inc_edge = c;
+            }
+            c->right = &fstore[k];
+        }
+    }
+    for (auto v : this->vertices)
+    {
+        vector<Edge*> out;
+        for (auto e : v->out)
+        {
+            if (remap(e) && e->isrequired)
+            {
+                out.push_back(remap(e));
+            }
+        }
+        v->out = out;
+        v->inc_edge = remap(this->edges[v->id]);
+    }
+    vector<Edge*> edges, twin_edges, lle;
+    for (int i = 0; i < n; i++)
+    {
+        edges.push_back(remap(this->edges[i]));
+        twin_edges.push_back(remap(this->twin_edges[i]));
+    }
+    for (int i = n; i < (int)this->edges.size(); i++)
+    {
+        if (this->edges[i]->isrequired)
+        {
+            edges.push_back(remap(this->edges[i]));
+            twin_edges.push_back(remap(this->twin_edges[i]));
+        }
+    }
+    for (auto e : this->LLE)
+    {
+        if (e->isrequired)
+        {
+            lle.push_back(remap(e));
+        }
+    }
+    if (!this->compacted)
+    {
+        for (auto e : this->edges)
+        {
+            delete e;
+        }
+        for (auto e : this->twin_edges)
+        {
+            delete e;
+        }
+        for (auto f : this->faces)
+        {
+            delete f;
+        }
+    }
+    this->edges = edges;
+    this->twin_edges = twin_edges;
+    this->LLE = lle;
+    this->faces.clear();
+    for (auto &f : fstore)
+    {
+        this->faces.push_back(&f);
+    }
+    this->edge_store.swap(estore);
+    this->face_store.swap(fstore);
+    this->compacted = true;
+    vector<int> begin;
+    for (auto e : cycles)
+    {
+        begin.push_back(index[e]);
+    }
+    begin.push_back(inner);
+    this->face_attributes(begin);
+}
+/**
+ * @brief Fills the face_* columns from the half-edges compact() laid out face after face: the coordinates of
+ * every face are gathered once into one ring array, closed by its first vertex again, and ring_attributes()
+ * runs over each ring in turn.
+ *
+ * @param begin index in edge_store of the first half-edge of every face, and of the outer twins at the end
+ */
+void DCEL::face_attributes(const vector<int>& begin)
+{
+    int F = begin.size() - 1;
+    vector<double> xs, ys;
+    xs.reserve(begin[F] + F);
+    ys.reserve(begin[F] + F);
+    for (int k = 0; k < F; k++)
+    {
+        for (int h = begin[k]; h < begin[k + 1]; h++)
+        {
+            xs.push_back(this->edge_store[h].org->x);
+            ys.push_back(this->edge_store[h].org->y);
+        }
+        xs.push_back(this->edge_store[begin[k]].org->x);
+        ys.push_back(this->edge_store[begin[k]].org->y);
+    }
+    for (auto c : {&this->face_area, &this->face_cx, &this->face_cy, &this->face_minx, &this->face_miny, &this->face_maxx, &this->face_maxy})
+    {
+        c->resize(F);
+    }
+    double out[7];
+    for (int k = 0, at = 0; k < F; k++)
+    {
+        int len = begin[k + 1] - begin[k];
+        ring_attributes(xs.data() + at, ys.data() + at, len, out);
+        this->face_area[k] = out[0];
+        this->face_cx[k] = out[1];
+        this->face_cy[k] = out[2];
+        this->face_minx[k] = out[3];
+        this->face_miny[k] = out[4];
+        this->face_maxx[k] = out[5];
+        this->face_maxy[k] = out[6];
+        at += len + 1;
+    }
 }
 /**
  * @brief Checks whether a vertex is convex or not in the original polygon.
@@ -266,6 +834,149 @@ void DCEL::rotate(Face* f){
         r=r->next;
     }while(r !=f->inc_edge);
 }
+/**
+ * @brief Adds the diagonal Back -> Front to the DCEL, splitting off the face on the side of diag.
+ * The reversed half-edge becomes the incident edge of Front, so it stays on the remaining polygon.
+ * 
+ * @param Front first vertex of the chain L
+ * @param Back last vertex of the chain L
+ */
+void DCEL::add_diagonal(Vertex* Front, Vertex* Back)
+{
+    Edge *rev = new Edge(Front, NULL, NULL, NULL, NULL);
+    Edge *diag = new Edge(Back, NULL, NULL, NULL, NULL);
+    diag->twin = rev;
+    rev->twin = diag;
+
+    Edge* ea = Front->inc_edge;
+    Edge* eaprevold = ea->prev;
+    Edge* eb = Back->inc_edge;
+    Edge* ebprevold = eb->prev;
+
+    diag->next = ea;
+    ea->prev = diag;
+    rev->next = eb;
+    eb->prev = rev;
+
+    diag->prev = ebprevold;
+    ebprevold->next = diag;
+    rev->prev = eaprevold;
+    eaprevold->next = rev;
+
+    this->edges.push_back(diag);
+    this->twin_edges.push_back(rev);
+
+    Face* curr_face = new Face(diag,this->faces.size());
+    diag->right = curr_face;
+    this->faces.push_back(curr_face);
+    Front->inc_edge = rev;
+    Front->out.push_back(rev);
+    Back->out.push_back(diag);
+    this->LLE.push_back(diag);
+}
+/**
+ * @brief Removes the j-th diagonal of LLE, joining the faces on both of its sides.
+ * The face on the side of the reversed half-edge is merged into the face on the side of the diagonal.
+ * 
+ * @param j index of the diagonal in LLE
+ */
+void DCEL::remove_diagonal(int j)
+{
+    Edge* ea = this->LLE[j]->prev;
+    Edge* ec = this->LLE[j]->next;
+    Edge* eb = this->LLE[j]->twin->next;
+    Edge* ed = this->LLE[j]->twin->prev;
+    ea->next = eb;
+    eb->prev = ea;
+    ec->prev = ed;
+    ed->next = ec;
+    this->LLE[j]->isrequired = false;
+    Face* fa = this->LLE[j]->right ? this->LLE[j]->right->find() : NULL;
+    Face* fb = this->LLE[j]->twin->right ? this->LLE[j]->twin->right->find() : NULL;
+    if (fa && fb && fa != fb)
+    {
+        fb->parent = fa;
+    }
+}
+/**
+ * @brief Runs the split of a small polygon on SmallPolygon and replays its diagonals on the DCEL.
+ * 
+ * @param diagonals no of diagonals, incremented by the ones added
+ * @return true if the small path handled the polygon.
+ * @return false if the general split has to be used; the DCEL is left untouched in that case.
+ */
+bool DCEL::split_small(int& diagonals)
+{
+    int n = this->vertices.size();
+    double xs[SMALL_POLYGON_LIMIT], ys[SMALL_POLYGON_LIMIT];
+    for (int i = 0; i < n; i++)
+    {
+        xs[i] = this->vertices[i]->x;
+        ys[i] = this->vertices[i]->y;
+    }
+    this->small.load(xs, ys, n);
+    if (!this->small.split())
+    {
+        return false;
+    }
+    for (int j = 0; j < this->small.m; j++)
+    {
+        int d = this->small.diag[j];
+        this->add_diagonal(this->vertices[this->small.org[this->small.twin[d]]], this->vertices[this->small.org[d]]);
+    }
+    diagonals += this->small.m;
+    this->small_split = true;
+    return true;
+}
+/**
+ * @brief Runs the merge of a small polygon on SmallPolygon and removes the same diagonals from the DCEL.
+ * 
+ * @return true if the small path handled the merge.
+ * @return false if the general merge has to be used.
+ */
+bool DCEL::merge_small()
+{
+    if (!this->small.merge())
+    {
+        return false;
+    }
+    for (int j = 0; j < this->small.m; j++)
+    {
+        if (this->small.removed[j])
+        {
+            this->remove_diagonal(j);
+        }
+    }
+    return true;
+}
+/**
+ * @brief Rebuilds the state split() leaves from a list of diagonals it produced earlier, in O(n).
+ * 
+ * @param diags the diagonals in the order they were added, as (id of Front, id of Back)
+ */
+void DCEL::replay_split(const vector<pair<int,int>>& diags)
+{
+    for (auto d : diags)
+    {
+        this->add_diagonal(this->vertices[d.first], this->vertices[d.second]);
+    }
+    this->close_faces(this->vertices.size());
+}
+/**
+ * @brief Rebuilds the state merge() leaves after replay_split(), in O(n).
+ * 
+ * @param removed removed[j] tells whether the j-th diagonal was removed by merge()
+ */
+void DCEL::replay_merge(const vector<bool>& removed)
+{
+    for (int j = 0; j < (int)removed.size(); j++)
+    {
+        if (removed[j])
+        {
+            this->remove_diagonal(j);
+        }
+    }
+}
 /**
  * @brief splitting the polygon 
  * 
@@ -275,105 +986,94 @@ void DCEL::rotate(Face* f){
 void DCEL:: split(int n,int& diagonals)
 {
     // cout
+    if (this->use_small_path and this->split_start == 0 and this->split_small(diagonals))
+    {
+        this->close_faces(n);
+        if (this->verbose)
+        {
+            cout << "Done Splitting\n";
+        }
+        return;
+    }
     
     // Algorithm implementation
     
     deque<Vertex *> L, P;
     // Step 1
+    int start = ((this->split_start % n) + n) % n;
     for (int i = 0; i < n; i++)
     {
-        P.push_back(this->vertices[i]);
+        P.push_back(this->vertices[(start + i) % n]);
     } 
+    // working state, reused by every iteration: pos[id] is the index of a vertex in P, a vertex is in L
+    // when stamp[id] == epoch, and notch[id] caches isnotch(), which only changes at the ends of a new diagonal
+    vector<int> pos(n), stamp(n, 0);
+    vector<char> notch(n);
+    int epoch = 0;
+    for (int i = 0; i < n; i++)
+    {
+        notch[i] = this->vertices[i]->isnotch();
+    }
+    auto index_P = [&]() {
+        for (int k = 0; k < (int)P.size(); k++)
+        {
+            pos[P[k]->id] = k;
+        }
+    };
+    auto next_in_P = [&](Vertex *v) { return P[(pos[v->id] + 1) % P.size()]; };
+    auto stamp_L = [&]() {
+        epoch++;
+        for (auto e : L)
+        {
+            stamp[e->id] = epoch;
+        }
+    };
+    index_P();
     // Step 2 
     int m = 1;
     int sz = n;
-    L.push_back(this->vertices[0]);
+    L.push_back(this->vertices[start]);
     // Step 3 
     int itr = 0;
+    this->budget_hit = false;
+    this->split_iterations = this->split_failed = this->split_backtracks = 0;
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double, milli>(this->split_budget_ms);
    
     while (sz > 3 and ++itr)
     {
+        if ((this->split_budget_iterations > 0 && itr > this->split_budget_iterations) ||
+            (this->split_budget_ms > 0 && chrono::steady_clock::now() >= deadline))
+        {
+            // out of budget: triangulate what is left of P
+            this->budget_hit = true;
+            this->clip_ears(P, diagonals);
+            break;
+        }
         // 3.1
         // if(m>2*n) break;
 
         Vertex *v1 = *(prev(L.end()));
-        Vertex *v2;
-        deque<Vertex *> ptemp = P;
- 
-        if (ptemp.back() == v1)
-        {
-            v2 = ptemp.front();
-        }
-        else
-        {
-            while (ptemp.size())
-            {
-                Vertex *vv = ptemp.front();
-                ptemp.pop_front();
-                if (vv == v1)
-                {
-                    v2 = ptemp.front();
-                    break;
-                }
-            }
-        }
+        Vertex *v2 = next_in_P(v1);
         // 3.2
         L = {v1, v2};
         int i = 2;
         Vertex *va = v1;
         Vertex *vb = v2;
-        Vertex *vc;
-        deque<Vertex *> Pd = P;
-        Vertex *lass = Pd.back();
-        if (lass == vb)
-        {
-            vc = Pd.front();
-        }
-        else
-        {
-            while (Pd.size())
-            {
-                // cout<<"f\n";
-                Vertex *v = Pd.front();
-                Pd.pop_front();
-                if (v == vb)
-                {
-                    vc = Pd.front();
-                    break;
-                }
-            }
-            //cout<<"\n\n\n";
-        }
+        Vertex *vc = next_in_P(vb);
  
         // 3.2
  
         // 3.3
        
-        while (!isreflex(va, vb, vc) and !isreflex(vb, vc, v1) and !isreflex(vc, v1, v2) and L.size() < sz)
+        // a vertex collinear with v1 and the end of L would leave a piece of no area or a diagonal through it
+        while (!isreflex(va, vb, vc) and !isreflex(vb, vc, v1) and !isreflex(vc, v1, v2) and !iscollinear(v1, vb, vc) and L.size() < sz)
         {
             L.push_back(vc);
             i++;
  
             va = vb;
             vb = vc;
-            deque<Vertex *> polo = P;
-            if (polo.back() == vc)
-            {
-                vc = polo.front();
-            }
-            else
-            {
-                while (polo.size())
-                {
-                    Vertex *polofront = polo.front();
-                    polo.pop_front();
-                    if (polofront == vc)
-                    {
-                        vc = polo.front();
-                        break;
-                    }
-                }
-            }
+            vc = next_in_P(vc);
              
         }
         // cout<<"itr = "<<itr<<" and L.size() = "<<L.size()<<endl;
@@ -385,111 +1085,89 @@ void DCEL:: split(int n,int& diagonals)
         {
             // 3.4.1
             
-            deque<Vertex *> LPVS;
+            vector<Vertex *> &LPVS = this->lpvs;
+            LPVS.clear();
+            stamp_L();
             for (auto it : P)
             {
-                bool found = false;
-                for (auto e : L)
-                {
-                    if (it == e)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
- 
-                if (!found and (it)->isnotch())
+                if (stamp[it->id] != epoch and notch[it->id])
                 {
                     LPVS.push_back(it);
                 }
  
                 // 3.4.1
             }
-            // 3.4.2
- 
-            while (LPVS.size())
+            // 3.4.2; LPVS[qh..] are the notches still to look at
+            size_t qh = 0;
+            while (qh < LPVS.size())
             {
-                double xmin, xmax, ymin, ymax;
-                deque<Vertex *> temp = L;
-                xmin = temp.front()->x; xmax = xmin;
-                ymin = temp.front()->y; ymax = ymin;
-                temp.pop_front();
-                while (temp.size())
+                double xmin = L.front()->x, xmax = xmin;
+                double ymin = L.front()->y, ymax = ymin;
+                for (auto ff : L)
                 {
-                    Vertex *ff = temp.front(); temp.pop_front();
                     xmin = min(xmin, ff->x); xmax = max(xmax, ff->x);
                     ymin = min(ymin, ff->y); ymax = max(ymax, ff->y);
                 }
  
                 bool backward = false;
-                while (!backward and LPVS.size() > 0)
+                while (!backward and qh < LPVS.size())
                 {
- 
-                    Vertex *v;
-                    deque<Vertex *> pol;
-                    do
+                    // keep the notches in the rectangle, in place
+                    size_t k = 0;
+                    for (size_t j = qh; j < LPVS.size(); j++)
                     {
-                        v = *(LPVS.begin());
-                        if (!v->isinRect( xmin, xmax, ymin, ymax))
-                        {
-                        }
-                        else
+                        if (LPVS[j]->isinRect(xmin, xmax, ymin, ymax))
                         {
-                            pol.push_back(v);
+                            LPVS[k++] = LPVS[j];
                         }
-                        LPVS.pop_front();
-                        // LPVS.pop_front();
-                    } while (LPVS.size() > 0);
- 
-                    while (pol.size() > 0)
-                    {
-                        Vertex *ab = pol.front();
-                        LPVS.push_back(ab);
-                        pol.pop_front();
                     }
+                    LPVS.resize(k);
+                    qh = 0;
  
-                    if (LPVS.size())
+                    if (qh < LPVS.size())
                     {
-                        v = LPVS.front();
+                        Vertex *v = LPVS[qh];
  
                         if (v->isInsidePolygon(L))
                         { 
-                            unordered_set<Vertex *> VTR;
+                            // trim L in place to the vertices on the other side of v1 -> v than its last one;
+                            // v1 is on the line, but rounding can put it on either side, so it is kept explicitly.
+                            // A vertex exactly on the line goes too, or the diagonal to it would run through v
                             Vertex *last = L.back();
-                            unordered_set<Vertex *> unwanted;
-                            for (auto e : L)
-                            {
-                                if (lieonsameside(v1, v, e, last))
-                                {
-                                   unwanted.insert(e);
-                                }
-                            }
-                            deque<Vertex *> LL;
-                            for (auto e : L)
-                            {
-                                if (!unwanted.count(e))
-                                {
-                                    LL.push_back(e);
-                                }
-                            }
-                            L = LL;
+                            L.erase(remove_if(L.begin(), L.end(), [&](Vertex *e) { return e != v1 && (lieonsameside(v1, v, e, last) || iscollinear(v1, v, e)); }), L.end());
  
                             backward = true;
-                            LPVS.pop_front();
-                            v = LPVS.front();
+                            this->split_backtracks++;
                             // MP1 ends
                         }
-                        else
+                        else if (liesbetween(v, L.back(), v1))
                         {
-                            LPVS.pop_front();
+                            // the diagonal would run through v
+                            L.pop_back();
+                            backward = true;
+                            this->split_backtracks++;
                         }
+                        qh++;
                     }
                 }
             }
             // 3.4.2
         }
  
-        if (L.size() and L.back() != v2)
+        // 3.4.3 where a boundary runs back over itself, as along the bridges of bridge_holes(), no notch needs
+        // to be inside L for its diagonal to leave P; cut L back until the diagonal starts into P at both ends
+        if (L.size() != P.size())
+        {
+            Vertex *before_v1 = P[(pos[v1->id] + P.size() - 1) % P.size()];
+            while (L.size() > 2 && !(leavesinside(L[L.size() - 2], L.back(), next_in_P(L.back()), v1) &&
+                                     leavesinside(before_v1, v1, v2, L.back())))
+            {
+                L.pop_back();
+                this->split_backtracks++;
+            }
+        }
+
+        if (L.size() > 2)
         {
             Vertex *Front = L.front();
             Vertex *Back = L.back();
@@ -503,81 +1181,21 @@ void DCEL:: split(int n,int& diagonals)
             {
                 diagonals++;
                 // 3.5.1 write Lm as partition
-                Edge *rev = new Edge(Front, NULL, NULL, NULL, NULL);
-                Edge *diag = new Edge(Back, NULL, NULL, NULL, NULL);
-                //cout<<"Adding diagonal from "<<diag->org->id<<" to "<<rev->org->id<<"\n";
-                diag->twin = rev;
-                rev->twin = diag;
- 
-                Edge* ea = Front->inc_edge;
-                Edge* eaprevold = ea->prev;
-                Edge* eb = Back->inc_edge;
-                Edge* ebprevold = eb->prev;
- 
-                diag->next = ea;
-                ea->prev = diag;
-                rev->next = eb;
-                eb->prev = rev;
- 
- 
-                diag->prev = ebprevold;
-                ebprevold->next = diag;
-                rev->prev = eaprevold;
-                eaprevold->next = rev;
-                Edge* pk = diag;
-                do{
-                    //cout<<pk->org->id<<" ";
-                    pk = pk->next;
-                }
-                while(pk!=diag);
-                //cout<<"\n";
- 
- 
- 
- 
- 
-                this->edges.push_back(diag);
-                //update
-                this->twin_edges.push_back(rev);
-                
-                Face* curr_face = new Face(diag,this->faces.size());
-                
-                diag->right = curr_face;
-                this->faces.push_back(curr_face);
-                Front->inc_edge = rev;
-                this->LLE.push_back(diag);
- 
+                this->add_diagonal(Front, Back);
+                notch[Front->id] = Front->isnotch();
+                notch[Back->id] = Back->isnotch();
                 // 3.5.1
                 // 3.5.2
             }
  
-            deque<Vertex *> PP;
+            // drop the inner vertices of L from P, in place
             Vertex *front_el = L.front();
             Vertex *back_el = L.back();
-            for (auto e1 : P)
-            {
-                bool flag = false;
-                for (auto e2 : L)
-                {
-                    if (e1 == e2)
-                    {
-                        flag = true;
-                        break;
-                    }
-                }
- 
-                if (!flag or (e1 == front_el) or (e1 == back_el))
-                {
-                    PP.push_back(e1);
-                }
-            }
-            P.clear();
-            while (PP.size())
-            {
-                Vertex *gg = PP.front();
-                PP.pop_front();
-                P.push_back(gg);
-            }
+            stamp_L();
+            P.erase(remove_if(P.begin(), P.end(), [&](Vertex *e1) {
+                return stamp[e1->id] == epoch and e1 != front_el and e1 != back_el;
+            }), P.end());
+            index_P();
  
             sz = sz - L.size() + 2;
             // 3.5.2
@@ -589,6 +1207,10 @@ void DCEL:: split(int n,int& diagonals)
             Vertex* gh = P.front();
             P.pop_front();
             P.push_back(gh);
+            index_P();
+            this->split_failed++;
+            // the next try starts from v2, also when the trimming took it out of L
+            L = {v1, v2};
             // continue;
             // L.pop_front();
             // continue;
@@ -606,11 +1228,111 @@ void DCEL:: split(int n,int& diagonals)
 
         
     }
-        
- 
- 
- 
- 
+    this->split_iterations = itr;
+    this->close_faces(n);
+    if (this->verbose)
+    {
+        cout << "Done Splitting\n";
+    }
+
+}
+/**
+ * @brief Triangulates the remaining polygon P by ear clipping, the fallback of split() once its budget is spent.
+ * Every ear a, b, c is cut off with the diagonal a -> c, the same way split() cuts off a chain L = a, b, c, so
+ * close_faces() and merge() work on the result as usual. Only reflex vertices can lie in an ear, so each
+ * candidate is tested against them alone; the whole fallback is O(r^2) for r vertices left, with no retries.
+ *
+ * @param P the vertices left, in the order of the polygon
+ * @param diagonals no of diagonals, incremented by the ones added
+ */
+void DCEL::clip_ears(deque<Vertex*>& P, int& diagonals)
+{
+    int r = P.size();
+    vector<Vertex*> v(P.begin(), P.end());
+    vector<int> nxt(r), prv(r);
+    for (int i = 0; i < r; i++)
+    {
+        nxt[i] = (i + 1) % r;
+        prv[i] = (i + r - 1) % r;
+    }
+    vector<char> reflex(r), alive(r, 1);
+    vector<int> notches;
+    for (int i = 0; i < r; i++)
+    {
+        reflex[i] = isreflex(v[prv[i]], v[i], v[nxt[i]]);
+        if (reflex[i])
+        {
+            notches.push_back(i);
+        }
+    }
+    auto side = [](Vertex* a, Vertex* b, Vertex* p) {
+        return (b->x - a->x) * (p->y - a->y) - (b->y - a->y) * (p->x - a->x);
+    };
+    auto inside = [&](Vertex* a, Vertex* b, Vertex* c, Vertex* p) {
+        double d1 = side(a, b, p), d2 = side(b, c, p), d3 = side(c, a, p);
+        bool neg = d1 < 0 || d2 < 0 || d3 < 0, pos = d1 > 0 || d2 > 0 || d3 > 0;
+        return !(neg && pos);
+    };
+    int left = r, i = 0, misses = 0;
+    while (left > 3)
+    {
+        int a = prv[i], c = nxt[i];
+        bool ear = !reflex[i];
+        if (ear)
+        {
+            // drop the notches that were cut off or became convex, then test the others
+            int keep = 0;
+            for (int j : notches)
+            {
+                if (!alive[j] || !reflex[j])
+                {
+                    continue;
+                }
+                notches[keep++] = j;
+                if (ear && j != a && j != c && v[j] != v[a] && v[j] != v[c] && inside(v[a], v[i], v[c], v[j]))
+                {
+                    ear = false;
+                }
+            }
+            notches.resize(keep);
+        }
+        // a full round without an ear only happens on degenerate input; cut the next vertex anyway
+        if (ear || misses > left)
+        {
+            if (v[a]->inc_edge->prev->org != v[c])
+            {
+                diagonals++;
+                this->add_diagonal(v[a], v[c]);
+            }
+            nxt[a] = c;
+            prv[c] = a;
+            alive[i] = 0;
+            reflex[a] = isreflex(v[prv[a]], v[a], v[c]);
+            reflex[c] = isreflex(v[a], v[c], v[nxt[c]]);
+            left--;
+            misses = 0;
+            i = a;
+        }
+        else
+        {
+            misses++;
+            i = nxt[i];
+        }
+    }
+    P.clear();
+    for (int k = 0, j = i; k < left; k++, j = nxt[j])
+    {
+        P.push_back(v[j]);
+    }
+}
+/**
+ * @brief Sets the right face of every half-edge after splitting and adds the faces left over by the split
+ * (the remaining polygon on both sides of the last diagonals).
+ *
+ * @param n no of vertices
+ */
+void DCEL::close_faces(int n)
+{
     for(Face* f:this->faces)
     {
         Edge* e = f->inc_edge;
@@ -625,7 +1347,6 @@ void DCEL:: split(int n,int& diagonals)
     }
  
     // cout<<"Remained Faces adding :";
-    Face* new_face = new Face(NULL,this->faces.size());
     Edge* tt;
     bool ff = false;
     for(auto ed:this->edges)
@@ -639,6 +1360,8 @@ void DCEL:: split(int n,int& diagonals)
     }
  
     if(ff){
+        // only allocated when some half-edge is left without a face, so nothing leaks otherwise
+        Face* new_face = new Face(NULL,this->faces.size());
         new_face->inc_edge = tt;
         Edge* t1 = tt;
         do{
@@ -657,7 +1380,6 @@ void DCEL:: split(int n,int& diagonals)
 
  
     // cout<<"\nRemained Faces adding :";
-    Face* new_face_rev = new Face(NULL,this->faces.size());
     int ss = this->twin_edges.size();
     for(int i=n;i<ss;i++){  
         Edge* et = this->twin_edges[i];
@@ -671,6 +1393,7 @@ void DCEL:: split(int n,int& diagonals)
    
  
     if(ff){
+        Face* new_face_rev = new Face(NULL,this->faces.size());
         new_face_rev->inc_edge = tt;
         Edge* t1 = tt;
         do{
@@ -682,12 +1405,6 @@ void DCEL:: split(int n,int& diagonals)
     }
             //   cout<<"Flag\n";
     // cout<<"\n";
- 
- 
- 
- 
-    cout << "Done Splitting\n";
-
 }
 /**
  * @brief This function merges adjacent triangles of the polygon using the polygon partitioning algorithm.
@@ -698,7 +1415,16 @@ void DCEL:: split(int n,int& diagonals)
  */
 void DCEL::merge(int n,int& m)
 {
+    if (this->small_split and this->merge_small())
+    {
+        if (this->verbose)
+        {
+            cout<<"Done Merging\n";
+        }
+        return;
+    }
    
+    auto lpv_start = chrono::steady_clock::now();
     unordered_map<Vertex*,vector<pair<int,Vertex*>>>LPV;
     vector<bool>LDP;
     deque<int>LUP;
@@ -708,44 +1434,27 @@ void DCEL::merge(int n,int& m)
         LUP.push_back(i);
     }
     
-    // build LPV
+    // build LPV from the half-edges leaving every vertex, one per face around it
     for(auto v:this->vertices){
         vector<pair<int,Vertex*>>tempvect;
-        for(auto f:this->faces){
-
-            bool found = false;
-            Edge* orig = f->inc_edge;
-            Edge* dup = orig;
-            do{
-                dup = dup->next;
-                if(dup->org == v){
-                    found = true;
-                    break;
-                }
+        for(auto e:v->out){
+            if(e->right == NULL){
+                continue;
             }
-            while(dup!=orig);
-            if(found){
-                Vertex* next_vertex;
-                orig = f->inc_edge;
-                dup = orig;
-                do{
-                    dup = dup->next;
-                    if(dup->org == v){
-                        next_vertex = dup->next->org;
-                    }
-                }
-                while(dup!=orig);
-                pair<int, Vertex*> yy = {f->id,next_vertex};
-                if(abs(next_vertex->id - v->id)!=1){
-                    tempvect.push_back(yy);
-                }
-                
+            bool seen = false;
+            for(auto &t:tempvect){
+                seen = seen || t.first == e->right->id;
+            }
+            Vertex* next_vertex = e->next->org;
+            if(!seen && abs(next_vertex->id - v->id)!=1){
+                tempvect.push_back({e->right->id,next_vertex});
             }
         }
 
         LPV[v] = tempvect;
     }
-
+    auto loop_start = chrono::steady_clock::now();
+    this->lpv_ms = chrono::duration<double, milli>(loop_start - lpv_start).count();
 
 
     for(int j=0;j<m;++j)
@@ -767,7 +1476,7 @@ void DCEL::merge(int n,int& m)
             Vertex* j3 = next_vertex(LLE[j]->right,vt);
             Vertex* i1 = prev_vertex(LLE[j]->right,vs);
             // 3.2.2
-            int u;
+            int u = -1;
          
             for(auto e: LPV[vt]){
                  
@@ -787,27 +1496,20 @@ void DCEL::merge(int n,int& m)
             // 3.2.4
             if(!isreflex(i1,i2,i3) && !isreflex(j1,j2,j3)){
                 np++;
+                int need = max(np, u) + 1;
+                if(need > (int)LDP.size()){
+                    LDP.resize(need, true);
+                    LUP.resize(need, np);
+                }
                 
-                
-                Edge* ea = this->LLE[j]->prev;
-                Edge* ec = this->LLE[j]->next;
-                Edge* eb = this->LLE[j]->twin->next;
-                Edge* ed = this->LLE[j]->twin->prev;
-
-                ea->next = eb;
-                eb->prev = ea;
-                ec->prev = ed;
-                ed->next = ec;
-
-
-
-
-                LLE[j]->isrequired = false;
+                this->remove_diagonal(j);
                 LDP[j] = false;
-                LDP[u] = false;
                 LDP[np] = true;
                 LUP[j] = np;
-                LUP[u] = np;
+                if(u >= 0){
+                    LDP[u] = false;
+                    LUP[u] = np;
+                }
 
                 for(int h = 0;h<np-2;++h){
                     if(LUP[h] == j || LUP[h] == u){
@@ -821,8 +1523,12 @@ void DCEL::merge(int n,int& m)
 
 
     }
+    this->merge_loop_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - loop_start).count();
 
-    cout<<"Done Merging\n";
+    if (this->verbose)
+    {
+        cout<<"Done Merging\n";
+    }
     // cout<<"here\n";
 
 
@@ -46,16 +46,7 @@ class Edge
  */
 bool Edge::isPresentInFace(Face* curr_face)
 {
-    Edge* start=curr_face->inc_edge;
-    Edge* temp=start;
-    do{
-        if(temp==this){
-            return true;
-        }
-        temp=temp->next;
-    }while(temp!=start);
-    return false;
-
+    return this->isrequired && this->twin->isrequired && this->right && this->right->find() == curr_face->find();
 }
 
 #endif
\ No newline at end of file
@@ -19,10 +19,30 @@ class Face
 public:
     int id;
     Edge *inc_edge;
+    Face *parent; // face this one was merged into, NULL if it is still a face of its own
     Face(Edge *ed, int id)
     {
         this->inc_edge = ed;
         this->id = id;
+        this->parent = NULL;
+    }
+    /**
+     * @brief Finds the face this face has been merged into, following parent (union-find with path halving).
+     * 
+     * @return the face that currently holds the region of this face
+     */
+    Face *find()
+    {
+        Face *f = this;
+        while (f->parent)
+        {
+            if (f->parent->parent)
+            {
+                f->parent = f->parent->parent;
+            }
+            f = f->parent;
+        }
+        return f;
     }
 };
 
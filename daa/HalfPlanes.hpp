@@ -0,0 +1,210 @@
+/**
+ * @file HalfPlanes.hpp
+ * @brief Export of the merged convex pieces as packed half-plane tables, with AVX2 containment kernels.
+ *
+ * The AVX2 kernels use fused multiply-adds, so they are used when the file is compiled with -mavx2 -mfma (or
+ * -march=native on a machine that has both); otherwise, -mavx2 alone included, the same tests run on scalar code.
+ */
+#ifndef HALFPLANES_H
+#define HALFPLANES_H
+
+#include <bits/stdc++.h>
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Edges of every convex piece as half-planes a*x + b*y + c <= 0, stored as aligned columns.
+ * @class HalfPlaneTable
+ *
+ * Row i of a, b and c describes one edge; a point is in piece k when every row of the piece is <= 0, boundary
+ * included. The rows of a piece start at a multiple of WIDTH and are padded up to the next one with rows
+ * (0, 0, -1) that every point satisfies, so the kernels read whole registers without a tail loop. The columns
+ * are 64-byte aligned.
+ */
+class HalfPlaneTable
+{
+public:
+    /**
+     * @brief Number of doubles per SIMD register, the padding unit of every piece.
+     */
+    static constexpr int WIDTH = 4;
+    /**
+     * @brief Vertex ids of every piece, in the order of the input polygon.
+     */
+    vector<vector<int>> pieces;
+    /**
+     * @brief Rows of piece k are [start[k], start[k+1]).
+     */
+    vector<int> start;
+    double *a, *b, *c;
+    int rows;
+
+    HalfPlaneTable(DCEL* dcel);
+    ~HalfPlaneTable();
+    HalfPlaneTable(const HalfPlaneTable&) = delete;
+    HalfPlaneTable& operator=(const HalfPlaneTable&) = delete;
+
+    void contains(int k, const double* xs, const double* ys, unsigned char* out, size_t count) const;
+    void contains(double x, double y, unsigned char* out) const;
+    void contains_scalar(int k, const double* xs, const double* ys, unsigned char* out, size_t count) const;
+    void contains_scalar(double x, double y, unsigned char* out) const;
+};
+/**
+ * @brief Builds the table from the faces of a DCEL on which merge() has already been run.
+ *
+ * @param dcel the merged DCEL
+ */
+HalfPlaneTable::HalfPlaneTable(DCEL* dcel)
+{
+    auto faces = dcel->convex_faces();
+    this->start.push_back(0);
+    for (auto &f : faces)
+    {
+        int m = f.size();
+        int padded = (m + WIDTH - 1) / WIDTH * WIDTH;
+        this->start.push_back(this->start.back() + padded);
+    }
+    this->rows = this->start.back();
+    size_t bytes = ((size_t)max(this->rows, WIDTH) * sizeof(double) + 63) / 64 * 64;
+    this->a = (double*)aligned_alloc(64, bytes);
+    this->b = (double*)aligned_alloc(64, bytes);
+    this->c = (double*)aligned_alloc(64, bytes);
+    for (size_t k = 0; k < faces.size(); k++)
+    {
+        auto &f = faces[k];
+        int m = f.size();
+        vector<int> ids;
+        double area = 0;
+        for (int i = 0; i < m; i++)
+        {
+            ids.push_back(f[i]->id);
+            area += f[i]->x * f[(i + 1) % m]->y - f[(i + 1) % m]->x * f[i]->y;
+        }
+        this->pieces.push_back(ids);
+        // inside is on the left of each edge for a counter clockwise piece, on the right for a clockwise one
+        double s = area < 0 ? -1 : 1;
+        int r = this->start[k];
+        for (int i = 0; i < m; i++, r++)
+        {
+            Vertex* p = f[i];
+            Vertex* q = f[(i + 1) % m];
+            this->a[r] = s * (q->y - p->y);
+            this->b[r] = -s * (q->x - p->x);
+            this->c[r] = -(this->a[r] * p->x + this->b[r] * p->y);
+        }
+        for (; r < this->start[k + 1]; r++)
+        {
+            this->a[r] = 0;
+            this->b[r] = 0;
+            this->c[r] = -1;
+        }
+    }
+}
+/**
+ * @brief Destroy the HalfPlaneTable::HalfPlaneTable object
+ *
+ */
+HalfPlaneTable::~HalfPlaneTable()
+{
+    free(this->a);
+    free(this->b);
+    free(this->c);
+}
+/**
+ * @brief Tests many points against one piece.
+ *
+ * @param k index of the piece
+ * @param xs x-coordinates of the points
+ * @param ys y-coordinates of the points
+ * @param out out[i] is set to 1 if point i is in the piece, 0 otherwise
+ * @param count number of points
+ */
+void HalfPlaneTable::contains(int k, const double* xs, const double* ys, unsigned char* out, size_t count) const
+{
+#if defined(__AVX2__) && defined(__FMA__)
+    size_t i = 0;
+    __m256d zero = _mm256_setzero_pd();
+    for (; i + WIDTH <= count; i += WIDTH)
+    {
+        __m256d x = _mm256_loadu_pd(xs + i);
+        __m256d y = _mm256_loadu_pd(ys + i);
+        __m256d outside = zero;
+        for (int r = this->start[k]; r < this->start[k + 1]; r++)
+        {
+            __m256d v = _mm256_fmadd_pd(_mm256_set1_pd(this->a[r]), x, _mm256_fmadd_pd(_mm256_set1_pd(this->b[r]), y, _mm256_set1_pd(this->c[r])));
+            outside = _mm256_or_pd(outside, _mm256_cmp_pd(v, zero, _CMP_GT_OQ));
+        }
+        int mask = _mm256_movemask_pd(outside);
+        for (int j = 0; j < WIDTH; j++)
+        {
+            out[i + j] = !((mask >> j) & 1);
+        }
+    }
+    this->contains_scalar(k, xs + i, ys + i, out + i, count - i);
+#else
+    this->contains_scalar(k, xs, ys, out, count);
+#endif
+}
+/**
+ * @brief Tests one point against every piece.
+ *
+ * @param x x-coordinate of the point
+ * @param y y-coordinate of the point
+ * @param out out[k] is set to 1 if the point is in piece k, 0 otherwise
+ */
+void HalfPlaneTable::contains(double x, double y, unsigned char* out) const
+{
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d X = _mm256_set1_pd(x);
+    __m256d Y = _mm256_set1_pd(y);
+    __m256d zero = _mm256_setzero_pd();
+    int k = this->pieces.size();
+    for (int p = 0; p < k; p++)
+    {
+        __m256d outside = zero;
+        for (int r = this->start[p]; r < this->start[p + 1]; r += WIDTH)
+        {
+            __m256d v = _mm256_fmadd_pd(_mm256_load_pd(this->a + r), X, _mm256_fmadd_pd(_mm256_load_pd(this->b + r), Y, _mm256_load_pd(this->c + r)));
+            outside = _mm256_or_pd(outside, _mm256_cmp_pd(v, zero, _CMP_GT_OQ));
+        }
+        out[p] = _mm256_movemask_pd(outside) == 0;
+    }
+#else
+    this->contains_scalar(x, y, out);
+#endif
+}
+/**
+ * @brief Scalar version of contains(k, xs, ys, out, count).
+ */
+void HalfPlaneTable::contains_scalar(int k, const double* xs, const double* ys, unsigned char* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        bool in = true;
+        for (int r = this->start[k]; r < this->start[k + 1]; r++)
+        {
+            in &= this->a[r] * xs[i] + this->b[r] * ys[i] + this->c[r] <= 0;
+        }
+        out[i] = in;
+    }
+}
+/**
+ * @brief Scalar version of contains(x, y, out).
+ */
+void HalfPlaneTable::contains_scalar(double x, double y, unsigned char* out) const
+{
+    int k = this->pieces.size();
+    for (int p = 0; p < k; p++)
+    {
+        bool in = true;
+        for (int r = this->start[p]; r < this->start[p + 1]; r++)
+        {
+            in &= this->a[r] * x + this->b[r] * y + this->c[r] <= 0;
+        }
+        out[p] = in;
+    }
+}
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * @file Holes.hpp
+ * @brief Turns a polygon with holes into one keyhole boundary that split() and merge() can decompose.
+ *
+ */
+#ifndef HOLES_H
+#define HOLES_H
+
+#include <bits/stdc++.h>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Boundary of a polygon with holes, cut open along one bridge per hole.
+ *
+ * Every hole is joined to the ring on its right by a horizontal bridge from its rightmost vertex. The boundary
+ * walks the outer ring clockwise and, at the far end of a bridge, goes along it, around the hole counter
+ * clockwise and back, so both ends of a bridge appear twice and the two passes over it are the two half-edges
+ * of a zero width corridor. Where a bridge ends inside an edge, a point is inserted there. Bridges may run
+ * along hole edges and through hole vertices; split() keeps its diagonals off them and out of the corridors.
+ */
+struct KeyholeBoundary
+{
+    vector<double> xs, ys; // vertices of the boundary, clockwise
+    vector<int> ids;       // index of every vertex in the input rings, numbered one ring after the other;
+                           // inserted points are numbered after all the input vertices
+    int inserted;          // number of inserted points
+};
+/**
+ * @brief x-coordinate where a non horizontal segment crosses the line at height y, exact at its end points.
+ */
+double x_at(double ax, double ay, double bx, double by, double y)
+{
+    if (y == ay)
+    {
+        return ax;
+    }
+    if (y == by)
+    {
+        return bx;
+    }
+    return ax + (y - ay) * (bx - ax) / (by - ay);
+}
+/**
+ * @brief Builds the keyhole boundary of a polygon with holes.
+ *
+ * The bridges are found by one sweep of a horizontal line from bottom to top over all the edges, which keeps
+ * the edges crossing the line ordered by x in a balanced tree: the bridge of a hole goes from its rightmost
+ * vertex to the first edge right of it on the line, which nothing crosses. Since that edge belongs to a ring
+ * reaching further right, following bridges always ends at the outer ring. O(n log n) for n vertices in all.
+ *
+ * The rings must be simple, the holes inside the outer ring and apart from each other and from it; each ring
+ * may be given in either orientation.
+ *
+ * @param xs x-coordinates of the rings, the outer ring first
+ * @param ys y-coordinates of the rings
+ * @return the boundary
+ */
+KeyholeBoundary bridge_holes(const vector<vector<double>>& xs, const vector<vector<double>>& ys)
+{
+    int rings = xs.size();
+    // nodes of all rings, outer ring clockwise and holes counter clockwise; inserted points are added later
+    vector<double> nx, ny;
+    vector<int> nid, nxt;
+    vector<int> first(rings + 1, 0);
+    int total = 0;
+    for (int r = 0; r < rings; r++)
+    {
+        int k = xs[r].size();
+        bool clockwise = signed_area(xs[r].data(), ys[r].data(), k) < 0;
+        bool flip = clockwise != (r == 0);
+        first[r] = nx.size();
+        for (int i = 0; i < k; i++)
+        {
+            int j = flip ? (k - i) % k : i;
+            nx.push_back(xs[r][j]);
+            ny.push_back(ys[r][j]);
+            nid.push_back(total + j);
+            nxt.push_back(first[r] + (i + 1) % k);
+        }
+        total += k;
+    }
+    first[rings] = nx.size();
+    int nodes = nx.size();
+    vector<int> ring_of(nodes);
+    for (int r = 0; r < rings; r++)
+    {
+        fill(ring_of.begin() + first[r], ring_of.begin() + first[r + 1], r);
+    }
+
+    // the edge from node a to nxt[a] is named by a; events are (y, kind, edge or hole), kind 0 inserts an edge,
+    // 1 shoots the bridge of a hole, 2 removes an edge, so edges ending on the line are still hit
+    vector<int> rightmost(rings, -1);
+    vector<tuple<double, int, int>> events;
+    for (int a = 0; a < nodes; a++)
+    {
+        int r = ring_of[a], b = nxt[a];
+        if (r > 0 && (rightmost[r] < 0 || nx[a] > nx[rightmost[r]] || (nx[a] == nx[rightmost[r]] && ny[a] > ny[rightmost[r]])))
+        {
+            rightmost[r] = a;
+        }
+        if (ny[a] != ny[b])
+        {
+            events.emplace_back(min(ny[a], ny[b]), 0, a);
+            events.emplace_back(max(ny[a], ny[b]), 2, a);
+        }
+    }
+    for (int r = 1; r < rings; r++)
+    {
+        events.emplace_back(ny[rightmost[r]], 1, r);
+    }
+    sort(events.begin(), events.end());
+
+    double sweep_y = 0;
+    auto edge_x = [&](int a) { return x_at(nx[a], ny[a], nx[nxt[a]], ny[nxt[a]], sweep_y); };
+    auto slope = [&](int a) { return (nx[nxt[a]] - nx[a]) / (ny[nxt[a]] - ny[a]); };
+    // edges do not cross, so their order on the line stays the same while they are in the tree; edges meeting
+    // at a vertex on the line are ordered by where they go above it
+    struct Order
+    {
+        using is_transparent = void;
+        decltype(edge_x)* ex;
+        decltype(slope)* sl;
+        bool operator()(int a, int b) const
+        {
+            double xa = (*ex)(a), xb = (*ex)(b);
+            if (xa != xb)
+            {
+                return xa < xb;
+            }
+            double sa = (*sl)(a), sb = (*sl)(b);
+            return sa != sb ? sa < sb : a < b;
+        }
+        bool operator()(double x, int b) const { return x < (*ex)(b); }
+        bool operator()(int a, double x) const { return (*ex)(a) < x; }
+    };
+    set<int, Order> active(Order{&edge_x, &slope});
+    vector<set<int, Order>::iterator> where(nodes);
+
+    // target node of every bridge, or the edge it ends inside of and where
+    vector<int> target(rings, -1);
+    vector<vector<pair<double, int>>> inside(nodes);
+    for (auto &ev : events)
+    {
+        sweep_y = get<0>(ev);
+        int kind = get<1>(ev), a = get<2>(ev);
+        if (kind == 0)
+        {
+            where[a] = active.insert(a).first;
+        }
+        else if (kind == 2)
+        {
+            active.erase(where[a]);
+        }
+        else
+        {
+            int m = rightmost[a];
+            auto it = active.upper_bound(nx[m]);
+            while (it != active.end() && ring_of[*it] == a)
+            {
+                it++;
+            }
+            if (it == active.end())
+            {
+                throw runtime_error("hole " + to_string(a) + " is not inside the outer ring");
+            }
+            int e = *it, f = nxt[e];
+            double x = edge_x(e);
+            if (x == nx[e] && sweep_y == ny[e])
+            {
+                target[a] = e;
+            }
+            else if (x == nx[f] && sweep_y == ny[f])
+            {
+                target[a] = f;
+            }
+            else
+            {
+                inside[e].push_back({fabs(x - nx[e]) + fabs(sweep_y - ny[e]), a});
+            }
+        }
+    }
+
+    // insert the points where bridges end inside edges, in order along each edge
+    KeyholeBoundary kb;
+    kb.inserted = 0;
+    for (int e = 0; e < nodes; e++)
+    {
+        sort(inside[e].begin(), inside[e].end());
+        int prev = e, after = nxt[e];
+        for (auto &p : inside[e])
+        {
+            int r = p.second, q = nx.size();
+            nx.push_back(x_at(nx[e], ny[e], nx[after], ny[after], ny[rightmost[r]]));
+            ny.push_back(ny[rightmost[r]]);
+            nid.push_back(total + kb.inserted++);
+            nxt.push_back(after);
+            nxt[prev] = q;
+            prev = q;
+            target[r] = q;
+        }
+    }
+    vector<vector<int>> holes_at(nx.size());
+    for (int r = 1; r < rings; r++)
+    {
+        holes_at[target[r]].push_back(r);
+    }
+
+    // walk the rings, going around every hole where its bridge ends; iterative, bridges may chain deeply
+    auto emit = [&](int v) {
+        kb.xs.push_back(nx[v]);
+        kb.ys.push_back(ny[v]);
+        kb.ids.push_back(nid[v]);
+    };
+    struct Walk
+    {
+        int start, at, hole; // ring walk from start, now at node at, next hole of holes_at[at] to enter
+    };
+    vector<Walk> stack = {{0, 0, 0}};
+    emit(0);
+    while (!stack.empty())
+    {
+        Walk &w = stack.back();
+        if (w.hole < (int)holes_at[w.at].size())
+        {
+            int m = rightmost[holes_at[w.at][w.hole++]];
+            emit(m);
+            stack.push_back({m, m, 0});
+            continue;
+        }
+        int v = nxt[w.at];
+        if (v == w.start)
+        {
+            stack.pop_back();
+            if (!stack.empty())
+            {
+                // back over the bridge: the rightmost vertex of the hole, then the node the bridge ends at
+                emit(v);
+                emit(stack.back().at);
+            }
+            continue;
+        }
+        w.at = v;
+        w.hole = 0;
+        emit(v);
+    }
+    return kb;
+}
+/**
+ * @brief Builds a DCEL for a polygon with holes over its keyhole boundary (see bridge_holes()).
+ *
+ * @param xs x-coordinates of the rings, the outer ring first
+ * @param ys y-coordinates of the rings
+ * @return the DCEL, owned by the caller, whose input_id gives the index of every vertex in the rings
+ */
+DCEL* build_with_holes(const vector<vector<double>>& xs, const vector<vector<double>>& ys)
+{
+    KeyholeBoundary kb = bridge_holes(xs, ys);
+    DCEL* dcel = new DCEL(kb.xs.size());
+    dcel->input_id = kb.ids;
+    dcel->build(kb.xs, kb.ys);
+    return dcel;
+}
+
+#endif
@@ -0,0 +1,500 @@
+/**
+ * @file LevelOfDetail.hpp
+ * @brief Convex decompositions of one polygon at several simplification tolerances, each level built from the
+ * coarser one and reusing its pieces where the outline did not change.
+ *
+ */
+#ifndef LEVELOFDETAIL_H
+#define LEVELOFDETAIL_H
+
+#include <bits/stdc++.h>
+#include "DCEL.hpp"
+#include "Simplify.hpp"
+using namespace std;
+/**
+ * @brief One level of detail: its outline and its convex pieces.
+ */
+struct LodLevel
+{
+    double tolerance;
+    vector<int> ids;            // vertices of the outline, clockwise, as indices of the input; a subset of the
+                                // finer level
+    vector<vector<int>> pieces; // convex pieces, clockwise, as indices of the input
+    int regions;                // regions the outline was cut into along diagonals of the coarser level
+    int decomposed;             // regions that changed and went through split() and merge()
+    int reused;                 // pieces taken over from the coarser level
+    double ms;                  // time spent on the level
+};
+/**
+ * @brief Convex pieces of the clockwise polygon through the given input vertices; a convex polygon is its own
+ * piece and skips split() and merge().
+ */
+vector<vector<int>> lod_pieces(const vector<double>& xs, const vector<double>& ys, const vector<int>& ids)
+{
+    int k = ids.size();
+    bool convex = true;
+    for (int i = 0; i < k && convex; i++)
+    {
+        int p = ids[i], q = ids[(i + 1) % k], r = ids[(i + 2) % k];
+        convex = orientation(xs[p], ys[p], xs[q], ys[q], xs[r], ys[r]) <= 0;
+    }
+    if (convex)
+    {
+        return {ids};
+    }
+    vector<double> px(k), py(k);
+    for (int i = 0; i < k; i++)
+    {
+        px[i] = xs[ids[i]];
+        py[i] = ys[ids[i]];
+    }
+    DCEL dcel(k);
+    dcel.verbose = false;
+    dcel.build(px, py);
+    int m = 0;
+    dcel.split(k, m);
+    dcel.merge(k, m);
+    vector<vector<int>> pieces;
+    for (auto &f : dcel.convex_faces())
+    {
+        vector<int> piece;
+        for (auto v : f)
+        {
+            piece.push_back(ids[dcel.source_id(v)]);
+        }
+        pieces.push_back(piece);
+    }
+    return pieces;
+}
+/**
+ * @brief Uniform grid of segments, each listed in every cell it passes through.
+ */
+struct LodGrid
+{
+    double x0, y0, w, h;
+    int g;
+    vector<vector<int>> cells;
+
+    LodGrid(double minx, double miny, double maxx, double maxy, int segments)
+    {
+        this->g = max(1, min(1024, (int)sqrt((double)segments)));
+        this->x0 = minx;
+        this->y0 = miny;
+        this->w = maxx > minx ? (maxx - minx) / this->g : 1;
+        this->h = maxy > miny ? (maxy - miny) / this->g : 1;
+        this->cells.resize((size_t)this->g * this->g);
+    }
+    int cell(double v, double lo, double size) const
+    {
+        return max(0, min(this->g - 1, (int)floor((v - lo) / size)));
+    }
+    /**
+     * @brief Calls f on every cell the segment passes through, column by column, with one more row on either
+     * side so rounding at cell borders loses nothing.
+     */
+    template <class F>
+    void visit(double ax, double ay, double bx, double by, F f)
+    {
+        if (ax > bx)
+        {
+            swap(ax, bx);
+            swap(ay, by);
+        }
+        int c0 = this->cell(ax, this->x0, this->w), c1 = this->cell(bx, this->x0, this->w);
+        for (int c = c0; c <= c1; c++)
+        {
+            double lx = max(ax, this->x0 + c * this->w), hx = min(bx, this->x0 + (c + 1) * this->w);
+            double ly = ay, hy = by;
+            if (bx > ax)
+            {
+                ly = ay + (lx - ax) * (by - ay) / (bx - ax);
+                hy = ay + (hx - ax) * (by - ay) / (bx - ax);
+            }
+            if (ly > hy)
+            {
+                swap(ly, hy);
+            }
+            int r0 = max(0, this->cell(ly, this->y0, this->h) - 1);
+            int r1 = min(this->g - 1, this->cell(hy, this->y0, this->h) + 1);
+            for (int r = r0; r <= r1; r++)
+            {
+                f(this->cells[(size_t)c * this->g + r]);
+            }
+        }
+    }
+};
+/**
+ * @brief Diagonals of the pieces of a decomposed level that are also diagonals of the outline of another.
+ *
+ * A diagonal of the decomposed level meets no edge the two outlines share except at its ends, so it is a
+ * diagonal of the other outline when both its ends are on it, it meets none of the edges only the other
+ * outline has, and it leaves both ends into the interior; those edges are looked up in a grid.
+ *
+ * @param xs x-coordinates of the input
+ * @param ys y-coordinates of the input
+ * @param done the decomposed level
+ * @param outline the other outline
+ * @return the diagonals, as pairs of input indices
+ */
+vector<pair<int, int>> lod_cuts(const vector<double>& xs, const vector<double>& ys, const LodLevel& done,
+                                const vector<int>& outline)
+{
+    int n = xs.size(), k = outline.size(), f = done.ids.size();
+    vector<int> done_next(n, -1), next(n, -1), prev(n, -1);
+    for (int i = 0; i < f; i++)
+    {
+        done_next[done.ids[i]] = done.ids[(i + 1) % f];
+    }
+    double minx = xs[outline[0]], maxx = minx, miny = ys[outline[0]], maxy = miny;
+    for (int i = 0; i < k; i++)
+    {
+        next[outline[i]] = outline[(i + 1) % k];
+        prev[outline[(i + 1) % k]] = outline[i];
+        minx = min(minx, xs[outline[i]]);
+        maxx = max(maxx, xs[outline[i]]);
+        miny = min(miny, ys[outline[i]]);
+        maxy = max(maxy, ys[outline[i]]);
+    }
+    vector<int> chords;
+    for (int u : outline)
+    {
+        if (done_next[u] != next[u])
+        {
+            chords.push_back(u);
+        }
+    }
+    LodGrid grid(minx, miny, maxx, maxy, chords.size());
+    for (int c = 0; c < (int)chords.size(); c++)
+    {
+        int u = chords[c], v = next[u];
+        grid.visit(xs[u], ys[u], xs[v], ys[v], [&](vector<int>& cell) { cell.push_back(c); });
+    }
+
+    auto orient = [&](int a, int b, int c) { return orientation(xs[a], ys[a], xs[b], ys[b], xs[c], ys[c]); };
+    // whether b, seen from a, is strictly inside the interior angle of the outline at a
+    auto enters = [&](int a, int b) {
+        int p = prev[a], q = next[a];
+        bool right_of_out = orient(a, q, b) < 0, right_of_in = orient(p, a, b) < 0;
+        return orient(p, a, q) <= 0 ? right_of_out && right_of_in : right_of_out || right_of_in;
+    };
+    vector<int> seen(chords.size(), -1);
+    int stamp = 0;
+    vector<pair<int, int>> cuts;
+    for (auto &piece : done.pieces)
+    {
+        int m = piece.size();
+        for (int i = 0; i < m; i++)
+        {
+            int a = piece[i], b = piece[(i + 1) % m];
+            // every diagonal shows up in the two pieces it separates, keep it once
+            if (a > b || done_next[a] == b || done_next[b] == a || next[a] < 0 || next[b] < 0 || next[a] == b ||
+                next[b] == a || !enters(a, b) || !enters(b, a))
+            {
+                continue;
+            }
+            stamp++;
+            bool clear = true;
+            grid.visit(xs[a], ys[a], xs[b], ys[b], [&](vector<int>& cell) {
+                for (int c : cell)
+                {
+                    int u = chords[c], v = next[u];
+                    if (!clear || seen[c] == stamp)
+                    {
+                        continue;
+                    }
+                    seen[c] = stamp;
+                    if (u != a && u != b && v != a && v != b &&
+                        segments_meet(xs[a], ys[a], xs[b], ys[b], xs[u], ys[u], xs[v], ys[v]))
+                    {
+                        clear = false;
+                    }
+                }
+            });
+            if (clear)
+            {
+                cuts.push_back({a, b});
+            }
+        }
+    }
+    return cuts;
+}
+/**
+ * @brief Cuts a clockwise outline along non crossing diagonals into regions, each clockwise.
+ *
+ * The neighbours of a vertex are ordered by how far along the outline they come after it, which is their
+ * order around it; a region is walked by leaving every vertex towards the neighbour just before the one it
+ * was entered from.
+ *
+ * @param outline vertices of the outline, as input indices
+ * @param cuts the diagonals, as pairs of input indices
+ * @param n number of input vertices
+ * @return the regions, as input indices
+ */
+vector<vector<int>> lod_regions(const vector<int>& outline, const vector<pair<int, int>>& cuts, int n)
+{
+    int k = outline.size();
+    vector<int> pos(n, -1);
+    for (int i = 0; i < k; i++)
+    {
+        pos[outline[i]] = i;
+    }
+    vector<vector<int>> off(k, vector<int>{1, k - 1});
+    for (auto &c : cuts)
+    {
+        int a = pos[c.first], b = pos[c.second];
+        off[a].push_back((b - a + k) % k);
+        off[b].push_back((a - b + k) % k);
+    }
+    vector<vector<char>> used(k);
+    for (int v = 0; v < k; v++)
+    {
+        sort(off[v].begin(), off[v].end());
+        used[v].assign(off[v].size(), 0);
+    }
+    vector<vector<int>> regions;
+    for (int v = 0; v < k; v++)
+    {
+        for (int j = 0; j < (int)off[v].size(); j++)
+        {
+            // the outline walked backwards bounds the outside
+            if (used[v][j] || off[v][j] == k - 1)
+            {
+                continue;
+            }
+            vector<int> region;
+            int a = v, i = j;
+            while (!used[a][i])
+            {
+                used[a][i] = 1;
+                region.push_back(outline[a]);
+                int b = (a + off[a][i]) % k, back = (a - b + k) % k;
+                i = lower_bound(off[b].begin(), off[b].end(), back) - off[b].begin() - 1;
+                a = b;
+            }
+            regions.push_back(region);
+        }
+    }
+    return regions;
+}
+/**
+ * @brief Removes the diagonals between pieces whose union is convex, like merge() does, for the diagonals the
+ * regions were cut along.
+ */
+void lod_merge_cuts(const vector<double>& xs, const vector<double>& ys, vector<vector<int>>& pieces,
+                    const vector<pair<int, int>>& cuts)
+{
+    long long n = xs.size();
+    auto key = [&](int a, int b) { return a * n + b; };
+    unordered_map<long long, int> owner;
+    for (int p = 0; p < (int)pieces.size(); p++)
+    {
+        int m = pieces[p].size();
+        for (int i = 0; i < m; i++)
+        {
+            owner[key(pieces[p][i], pieces[p][(i + 1) % m])] = p;
+        }
+    }
+    auto orient = [&](int a, int b, int c) { return orientation(xs[a], ys[a], xs[b], ys[b], xs[c], ys[c]); };
+    for (auto &c : cuts)
+    {
+        int a = c.first, b = c.second;
+        auto l = owner.find(key(a, b)), r = owner.find(key(b, a));
+        if (l == owner.end() || r == owner.end() || l->second == r->second)
+        {
+            continue;
+        }
+        int lp = l->second, rp = r->second;
+        // the left piece as b .. a and the right one as a .. b, so they join at both ends
+        vector<int> left = pieces[lp], right = pieces[rp];
+        rotate(left.begin(), find(left.begin(), left.end(), b), left.end());
+        rotate(right.begin(), find(right.begin(), right.end(), a), right.end());
+        if (orient(left[left.size() - 2], a, right[1]) > 0 || orient(right[right.size() - 2], b, left[1]) > 0)
+        {
+            continue;
+        }
+        owner.erase(key(a, b));
+        owner.erase(key(b, a));
+        for (size_t i = 1; i + 1 < right.size(); i++)
+        {
+            left.push_back(right[i]);
+        }
+        for (size_t i = 0; i < right.size() - 1; i++)
+        {
+            owner[key(right[i], right[i + 1])] = lp;
+        }
+        pieces[lp] = left;
+        pieces[rp].clear();
+    }
+    pieces.erase(remove_if(pieces.begin(), pieces.end(), [](const vector<int>& p) { return p.empty(); }),
+                 pieces.end());
+}
+/**
+ * @brief Decomposes a level from another one already decomposed: the outline is cut into regions along the
+ * diagonals of the other level that are still diagonals of it; a region whose outline the two levels share
+ * takes over the pieces of the other level inside it, the others go through split() and merge(). The
+ * diagonals the regions were cut along are merged away where they can be at the end.
+ */
+void lod_refine(const vector<double>& xs, const vector<double>& ys, const LodLevel& done, LodLevel& level)
+{
+    int n = xs.size(), f = done.ids.size();
+    vector<pair<int, int>> cuts = lod_cuts(xs, ys, done, level.ids);
+    vector<vector<int>> regions = lod_regions(level.ids, cuts, n);
+    long long N = n;
+    auto key = [&](int a, int b) { return a * N + b; };
+    unordered_set<long long> cut;
+    for (auto &c : cuts)
+    {
+        cut.insert(key(c.first, c.second));
+        cut.insert(key(c.second, c.first));
+    }
+    vector<int> done_next(n, -1);
+    for (int i = 0; i < f; i++)
+    {
+        done_next[done.ids[i]] = done.ids[(i + 1) % f];
+    }
+
+    // the pieces of the decomposed level in one region are those joined by diagonals that were not cut
+    int P = done.pieces.size();
+    vector<int> parent(P);
+    iota(parent.begin(), parent.end(), 0);
+    function<int(int)> root = [&](int p) { return parent[p] == p ? p : parent[p] = root(parent[p]); };
+    unordered_map<long long, int> owner;
+    for (int p = 0; p < P; p++)
+    {
+        auto &piece = done.pieces[p];
+        int m = piece.size();
+        for (int i = 0; i < m; i++)
+        {
+            int a = piece[i], b = piece[(i + 1) % m];
+            owner[key(a, b)] = p;
+            auto twin = owner.find(key(b, a));
+            if (twin != owner.end() && !cut.count(key(a, b)))
+            {
+                parent[root(p)] = root(twin->second);
+            }
+        }
+    }
+    vector<vector<int>> members(P);
+    for (int p = 0; p < P; p++)
+    {
+        members[root(p)].push_back(p);
+    }
+
+    level.regions = regions.size();
+    level.decomposed = level.reused = 0;
+    for (auto &region : regions)
+    {
+        int m = region.size();
+        bool same = true;
+        for (int i = 0; i < m && same; i++)
+        {
+            int a = region[i], b = region[(i + 1) % m];
+            same = done_next[a] == b || cut.count(key(a, b));
+        }
+        if (same)
+        {
+            for (int p : members[root(owner[key(region[0], region[1])])])
+            {
+                level.pieces.push_back(done.pieces[p]);
+                level.reused++;
+            }
+        }
+        else
+        {
+            for (auto &piece : lod_pieces(xs, ys, region))
+            {
+                level.pieces.push_back(piece);
+            }
+            level.decomposed++;
+        }
+    }
+    lod_merge_cuts(xs, ys, level.pieces, cuts);
+}
+/**
+ * @brief Decomposes a polygon at several tolerances in one pass.
+ *
+ * The outlines are simplified from the finest to the coarsest, every one from the finer one with
+ * simplify_polygon(), so the vertices of a level are a subset of those of the finer levels. They are then
+ * decomposed from the coarsest, which is cheap and the only one decomposed whole, to the finest, each with
+ * lod_refine() from the coarser one: its diagonals cut the finer outline into small regions, and split() and
+ * merge() only run inside the regions that changed. The diagonals the regions were cut along stay unless
+ * merging them away leaves a convex piece, so a level may have a few more pieces than decomposing its outline
+ * on its own.
+ *
+ * @param xs x-coordinates of the polygon, in either orientation
+ * @param ys y-coordinates of the polygon
+ * @param tolerances the tolerances, in any order
+ * @return the levels, by increasing tolerance
+ */
+vector<LodLevel> decompose_levels(const vector<double>& xs, const vector<double>& ys, vector<double> tolerances)
+{
+    int n = xs.size(), L = tolerances.size();
+    sort(tolerances.begin(), tolerances.end());
+    vector<int> input(n);
+    iota(input.begin(), input.end(), 0);
+    if (signed_area(xs.data(), ys.data(), n) > 0)
+    {
+        reverse(input.begin() + 1, input.end());
+    }
+    vector<LodLevel> levels(L);
+    for (int l = 0; l < L; l++)
+    {
+        auto start = chrono::steady_clock::now();
+        const vector<int>& from = l == 0 ? input : levels[l - 1].ids;
+        vector<double> fx, fy;
+        for (int i : from)
+        {
+            fx.push_back(xs[i]);
+            fy.push_back(ys[i]);
+        }
+        levels[l].tolerance = tolerances[l];
+        for (int k : simplify_polygon(fx, fy, tolerances[l]))
+        {
+            levels[l].ids.push_back(from[k]);
+        }
+        levels[l].ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    for (int l = L - 1; l >= 0; l--)
+    {
+        auto start = chrono::steady_clock::now();
+        if (l == L - 1)
+        {
+            levels[l].pieces = lod_pieces(xs, ys, levels[l].ids);
+            levels[l].regions = levels[l].decomposed = 1;
+            levels[l].reused = 0;
+        }
+        else
+        {
+            lod_refine(xs, ys, levels[l + 1], levels[l]);
+        }
+        levels[l].ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    return levels;
+}
+/**
+ * @brief Writes the levels: their number, then for every level a line "level tolerance vertices pieces" and
+ * one line of input indices per piece.
+ */
+void write_levels(ostream& out, const vector<LodLevel>& levels)
+{
+    out << levels.size() << "\n";
+    string line;
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        out << l << " " << levels[l].tolerance << " " << levels[l].ids.size() << " " << levels[l].pieces.size()
+            << "\n";
+        for (auto &piece : levels[l].pieces)
+        {
+            line.clear();
+            for (int v : piece)
+            {
+                line += to_string(v);
+                line += ' ';
+            }
+            line.back() = '\n';
+            out << line;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,335 @@
+/**
+ * @file MemoryStats.hpp
+ * @brief Per-phase heap accounting through a replacement of the global operator new and delete.
+ *
+ * The counting needs -DMEMORY_STATS: with it, including this file replaces every global operator new and delete
+ * (plain, nothrow and aligned) for the whole program, so it has to be included by exactly one translation unit
+ * (main.cpp or bench.cpp), never by a library. Every block gets a header holding its size and its offset from
+ * the start of the malloc'ed block, which is how operator delete knows how many bytes leave the live heap and
+ * what to free. Without the flag nothing is replaced, phase(), finish() and report() do nothing, and only
+ * rss_kb() and peak_rss_kb() are of use.
+ */
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <bits/stdc++.h>
+#include <sys/resource.h>
+#include <unistd.h>
+using namespace std;
+/**
+ * @brief Allocation counters of the program, split in named phases.
+ * @class MemoryStats
+ *
+ * phase() closes the running phase and opens a new one; the allocations made until the next call are charged
+ * to it, from any thread. For every phase we keep the number and bytes of allocations, the highest live heap
+ * reached while it ran, and the resident set size at its end together with the peak resident set size of the
+ * process so far (VmHWM), both sampled when the phase is closed.
+ */
+class MemoryStats
+{
+public:
+    static constexpr int MAX_PHASES = 32;
+#ifdef MEMORY_STATS
+    static constexpr bool counting = true;
+#else
+    static constexpr bool counting = false;
+#endif
+    struct Phase
+    {
+        const char* name;
+        long long allocs, bytes;  // allocations made during the phase
+        long long peak_live;      // highest live heap bytes during the phase
+        long long rss_kb;         // resident set size when the phase was closed
+        long long peak_rss_kb;    // peak resident set size of the process when the phase was closed
+    };
+
+    static void phase(const char* name);
+    static void finish();
+    static void reset();
+    static vector<Phase> phases();
+    static void report(ostream& out);
+    static long long live();
+    static long long rss_kb();
+    static long long peak_rss_kb();
+
+    static void on_alloc(size_t bytes);
+    static void on_free(size_t bytes);
+
+private:
+    static inline atomic<long long> live_bytes{0};
+    static inline atomic<int> current{-1};
+    static inline int count = 0;
+    static inline const char* names[MAX_PHASES];
+    static inline atomic<long long> allocs[MAX_PHASES], bytes[MAX_PHASES], peak[MAX_PHASES];
+    static inline long long rss[MAX_PHASES], peak_rss[MAX_PHASES];
+};
+/**
+ * @brief Charges an allocation to the running phase.
+ */
+void MemoryStats::on_alloc(size_t size)
+{
+    long long now = live_bytes.fetch_add(size, memory_order_relaxed) + size;
+    int p = current.load(memory_order_relaxed);
+    if (p < 0)
+    {
+        return;
+    }
+    allocs[p].fetch_add(1, memory_order_relaxed);
+    bytes[p].fetch_add(size, memory_order_relaxed);
+    long long old = peak[p].load(memory_order_relaxed);
+    while (now > old && !peak[p].compare_exchange_weak(old, now, memory_order_relaxed))
+    {
+    }
+}
+/**
+ * @brief Takes a freed block off the live heap.
+ */
+void MemoryStats::on_free(size_t size)
+{
+    live_bytes.fetch_sub(size, memory_order_relaxed);
+}
+/**
+ * @brief Closes the running phase, if any, and starts a new one.
+ *
+ * @param name name of the new phase, a string that outlives the report
+ */
+void MemoryStats::phase(const char* name)
+{
+    if (!counting)
+    {
+        return;
+    }
+    finish();
+    if (count == MAX_PHASES)
+    {
+        return;
+    }
+    int p = count++;
+    names[p] = name;
+    allocs[p] = 0;
+    bytes[p] = 0;
+    peak[p] = live_bytes.load();
+    current = p;
+}
+/**
+ * @brief Closes the running phase and samples the resident set size for it.
+ */
+void MemoryStats::finish()
+{
+    if (!counting)
+    {
+        return;
+    }
+    int p = current.exchange(-1);
+    if (p >= 0)
+    {
+        rss[p] = rss_kb();
+        peak_rss[p] = max(rss[p], peak_rss_kb());
+    }
+}
+/**
+ * @brief Forgets every phase, keeping the live heap count.
+ */
+void MemoryStats::reset()
+{
+    finish();
+    count = 0;
+}
+/**
+ * @brief The phases recorded so far, the running one included.
+ */
+vector<MemoryStats::Phase> MemoryStats::phases()
+{
+    vector<Phase> res;
+    int running = current.load();
+    for (int p = 0; p < count; p++)
+    {
+        long long r = p == running ? rss_kb() : rss[p];
+        long long pr = p == running ? max(r, peak_rss_kb()) : peak_rss[p];
+        res.push_back({names[p], allocs[p].load(), bytes[p].load(), peak[p].load(), r, pr});
+    }
+    return res;
+}
+/**
+ * @brief Prints one line per phase.
+ *
+ * @param out the stream to print to
+ */
+void MemoryStats::report(ostream& out)
+{
+    for (auto &p : phases())
+    {
+        out << "Memory " << p.name << ": " << p.allocs << " allocations, " << p.bytes << " bytes, peak heap "
+            << p.peak_live << " bytes, rss " << p.rss_kb << " kB, peak rss " << p.peak_rss_kb << " kB" << endl;
+    }
+}
+/**
+ * @brief Bytes currently allocated through operator new.
+ */
+long long MemoryStats::live()
+{
+    return live_bytes.load();
+}
+/**
+ * @brief Current resident set size in kB, from /proc/self/statm; 0 where it is not available.
+ */
+long long MemoryStats::rss_kb()
+{
+    long long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f)
+    {
+        if (fscanf(f, "%lld %lld", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+/**
+ * @brief Peak resident set size of the process in kB.
+ */
+long long MemoryStats::peak_rss_kb()
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+#ifdef MEMORY_STATS
+/**
+ * @brief Bytes in front of every block: its size and its offset from the start of the malloc'ed memory. Blocks
+ * aligned to more than this get a header as large as their alignment.
+ */
+static constexpr size_t MEMORY_HEADER = 16;
+/**
+ * @brief Allocates and counts a block for the replaced operators. It is kept out of line so that the compiler
+ * does not follow the pointer from malloc() to a new-expression and back to free().
+ *
+ * @param size bytes asked for
+ * @param align alignment asked for
+ * @return the block, or NULL if there is no memory
+ */
+__attribute__((noinline)) static void* memory_stats_alloc(size_t size, size_t align)
+{
+    size_t header = max(MEMORY_HEADER, align);
+    void* block = NULL;
+    if (align <= MEMORY_HEADER ? !(block = malloc(size + header)) : posix_memalign(&block, align, size + header))
+    {
+        return NULL;
+    }
+    size_t* p = (size_t*)((char*)block + header);
+    p[-2] = size;
+    p[-1] = header;
+    MemoryStats::on_alloc(size);
+    return p;
+}
+/**
+ * @brief Takes a block of memory_stats_alloc() off the live heap and frees it.
+ */
+__attribute__((noinline)) static void memory_stats_free(void* p)
+{
+    if (p)
+    {
+        size_t* q = (size_t*)p;
+        MemoryStats::on_free(q[-2]);
+        free((char*)p - q[-1]);
+    }
+}
+/**
+ * @brief memory_stats_alloc() for the operators that throw.
+ */
+static void* memory_stats_new(size_t size, size_t align)
+{
+    void* p = memory_stats_alloc(size, align);
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size)
+{
+    return memory_stats_new(size, MEMORY_HEADER);
+}
+void* operator new[](size_t size)
+{
+    return memory_stats_new(size, MEMORY_HEADER);
+}
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return memory_stats_alloc(size, MEMORY_HEADER);
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return memory_stats_alloc(size, MEMORY_HEADER);
+}
+void* operator new(size_t size, align_val_t align)
+{
+    return memory_stats_new(size, (size_t)align);
+}
+void* operator new[](size_t size, align_val_t align)
+{
+    return memory_stats_new(size, (size_t)align);
+}
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept
+{
+    return memory_stats_alloc(size, (size_t)align);
+}
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept
+{
+    return memory_stats_alloc(size, (size_t)align);
+}
+void operator delete(void* p) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p, size_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete(void* p, align_val_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p, align_val_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete(void* p, size_t, align_val_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p, size_t, align_val_t) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept
+{
+    memory_stats_free(p);
+}
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept
+{
+    memory_stats_free(p);
+}
+#endif
+
+#endif
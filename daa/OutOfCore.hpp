@@ -0,0 +1,565 @@
+/**
+ * @file OutOfCore.hpp
+ * @brief Decomposition of polygons too large for memory: the coordinates are read through a sliding memory
+ * map, the polygon is cut into vertical slabs and every part of it in a slab is decomposed on its own.
+ *
+ */
+#ifndef OUTOFCORE_H
+#define OUTOFCORE_H
+
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Read-only view of a binary coordinate file, n pairs of doubles "x y" in native byte order, of which
+ * only a window of a fixed size is mapped at a time.
+ * @class MappedCoords
+ */
+class MappedCoords
+{
+public:
+    MappedCoords(const string& path, size_t window_bytes);
+    ~MappedCoords();
+    long long size() const;
+    void point(long long i, double& x, double& y);
+
+private:
+    int fd;
+    long long n;
+    size_t window;      // bytes mapped at a time, a multiple of the page size
+    char* base;         // start of the mapping, NULL if nothing is mapped
+    long long from, to; // file offsets mapped
+};
+/**
+ * @brief Opens a coordinate file.
+ *
+ * @param path the file
+ * @param window_bytes how much of it may be mapped at once
+ */
+MappedCoords::MappedCoords(const string& path, size_t window_bytes)
+{
+    this->fd = open(path.c_str(), O_RDONLY);
+    if (this->fd < 0)
+    {
+        throw runtime_error("cannot open " + path);
+    }
+    struct stat st;
+    fstat(this->fd, &st);
+    this->n = st.st_size / (2 * sizeof(double));
+    long page = sysconf(_SC_PAGESIZE);
+    this->window = max<size_t>(window_bytes / page, 2) * page;
+    this->base = NULL;
+    this->from = this->to = 0;
+}
+
+MappedCoords::~MappedCoords()
+{
+    if (this->base)
+    {
+        munmap(this->base, this->to - this->from);
+    }
+    close(this->fd);
+}
+/**
+ * @brief Number of points in the file.
+ */
+long long MappedCoords::size() const
+{
+    return this->n;
+}
+/**
+ * @brief Reads point i, moving the window so that it is centred on the point if it is not mapped yet.
+ * Only the pages of the window count towards the resident set, whatever the size of the file.
+ */
+void MappedCoords::point(long long i, double& x, double& y)
+{
+    long long at = i * 2 * sizeof(double);
+    if (!this->base || at < this->from || at + (long long)(2 * sizeof(double)) > this->to)
+    {
+        if (this->base)
+        {
+            munmap(this->base, this->to - this->from);
+        }
+        long long bytes = this->n * 2 * sizeof(double);
+        long page = sysconf(_SC_PAGESIZE);
+        this->from = max(0LL, at - (long long)this->window / 2) / page * page;
+        this->to = min(bytes, this->from + (long long)this->window);
+        this->base = (char*)mmap(NULL, this->to - this->from, PROT_READ, MAP_PRIVATE, this->fd, this->from);
+        if (this->base == MAP_FAILED)
+        {
+            this->base = NULL;
+            throw runtime_error("cannot map the coordinate file");
+        }
+        madvise(this->base, this->to - this->from, MADV_SEQUENTIAL);
+    }
+    const double* p = (const double*)(this->base + (at - this->from));
+    x = p[0];
+    y = p[1];
+}
+/**
+ * @brief Settings of decompose_out_of_core().
+ */
+struct OutOfCoreOptions
+{
+    long long chunk;     // most polygon vertices in one slab, and so in memory at once
+    size_t window_bytes; // size of the window mapped over the coordinate file
+};
+/**
+ * @brief Counters of decompose_out_of_core().
+ */
+struct OutOfCoreStats
+{
+    long long slabs;     // vertical slabs the polygon was cut into
+    long long chunks;    // parts of the polygon in a slab, each decomposed on its own
+    long long pieces;    // convex pieces written
+    long long inserted;  // points inserted where edges cross the slab boundaries
+    int passes;          // passes over the coordinate file
+    long long oversized; // vertices of chunks larger than opt.chunk, where many vertices share an x or many
+                         // edges cross a slab
+};
+/**
+ * @brief The polygon of a coordinate file, walked clockwise.
+ */
+struct OutOfCorePolygon
+{
+    MappedCoords* coords;
+    long long n;
+    bool reversed; // walk the file backwards, keeping point 0 first
+
+    void point(long long i, double& x, double& y)
+    {
+        this->coords->point(this->id(i), x, y);
+    }
+    long long id(long long i) const
+    {
+        return this->reversed ? (this->n - i) % this->n : i;
+    }
+};
+/**
+ * @brief Runs split() and merge() on a clockwise polygon held in memory and appends its pieces to out, one
+ * line of ids per piece.
+ */
+long long decompose_chunk(vector<double>& xs, vector<double>& ys, const vector<long long>& ids, ostream& out)
+{
+    int n = xs.size();
+    DCEL dcel(n);
+    dcel.verbose = false;
+    dcel.build(xs, ys);
+    int m = 0;
+    dcel.split(n, m);
+    dcel.merge(n, m);
+    long long pieces = 0;
+    string line;
+    for (auto &f : dcel.convex_faces())
+    {
+        line.clear();
+        for (auto v : f)
+        {
+            line += to_string(ids[dcel.source_id(v)]);
+            line += ' ';
+        }
+        line.back() = '\n';
+        out << line;
+        pieces++;
+    }
+    return pieces;
+}
+/**
+ * @brief Point where the boundary crosses the line between two slabs.
+ *
+ * A vertex on the line counts as right of it, so an edge from the left ending on it crosses the line at the
+ * vertex itself; key orders such crossings on the line as if the vertex were moved right by an infinitesimal
+ * amount, which keeps them alternating between leaving and entering.
+ */
+struct SlabPoint
+{
+    double x, y, key;
+    long long id; // the vertex the crossing is at, or the id of the inserted point
+};
+/**
+ * @brief Part of the boundary inside one slab: from where it enters the slab, through vertices start ..
+ * start + count - 1 of the walk (modulo n), to where it leaves.
+ */
+struct SlabChain
+{
+    long long slab;
+    SlabPoint entry, exit;
+    bool entry_left, exit_left; // on the left line of the slab, else on the right one
+    long long start, count;
+};
+/**
+ * @brief Reads every vertex of the polygon in walk order once, counting the pass.
+ */
+template <class F>
+void ooc_pass(OutOfCorePolygon& poly, OutOfCoreStats& stats, F f)
+{
+    stats.passes++;
+    double x, y;
+    for (long long i = 0; i < poly.n; i++)
+    {
+        poly.point(i, x, y);
+        f(i, x, y);
+    }
+}
+/**
+ * @brief Chooses the slab boundaries so that every slab holds at most chunk vertices: ranges of x with more
+ * are cut at the quantiles of a histogram of their vertices, one pass per round. A last pass moves the
+ * boundaries off the vertices.
+ *
+ * @return the x of the boundaries, increasing
+ */
+vector<double> choose_slabs(OutOfCorePolygon& poly, long long chunk, double lox, double hix, OutOfCoreStats& stats)
+{
+    const int BINS = 256;
+    struct Range
+    {
+        double lo, hi;
+        long long count;
+    };
+    vector<Range> ranges = {{lox, hix, poly.n}};
+    for (int round = 0; round < 8; round++)
+    {
+        vector<int> slot(ranges.size(), -1);
+        int over = 0;
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            if (ranges[r].count > chunk && ranges[r].hi > ranges[r].lo)
+            {
+                slot[r] = over++;
+            }
+        }
+        if (over == 0)
+        {
+            break;
+        }
+        vector<double> los;
+        for (auto &r : ranges)
+        {
+            los.push_back(r.lo);
+        }
+        vector<long long> hist((size_t)over * BINS, 0);
+        ooc_pass(poly, stats, [&](long long, double x, double) {
+            int r = upper_bound(los.begin(), los.end(), x) - los.begin() - 1;
+            if (slot[r] >= 0)
+            {
+                int b = (x - ranges[r].lo) / (ranges[r].hi - ranges[r].lo) * BINS;
+                hist[(size_t)slot[r] * BINS + min(max(b, 0), BINS - 1)]++;
+            }
+        });
+        vector<Range> next;
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            if (slot[r] < 0)
+            {
+                next.push_back(ranges[r]);
+                continue;
+            }
+            const long long* h = &hist[(size_t)slot[r] * BINS];
+            double lo = ranges[r].lo, width = (ranges[r].hi - ranges[r].lo) / BINS;
+            int b = 0;
+            while (b < BINS)
+            {
+                int e = b;
+                long long sum = h[e++];
+                while (e < BINS && sum + h[e] <= chunk)
+                {
+                    sum += h[e++];
+                }
+                next.push_back({lo + b * width, e == BINS ? ranges[r].hi : lo + e * width, sum});
+                b = e;
+            }
+        }
+        ranges = next;
+    }
+    vector<double> bounds;
+    for (size_t r = 1; r < ranges.size(); r++)
+    {
+        bounds.push_back(ranges[r].lo);
+    }
+    if (bounds.empty())
+    {
+        return bounds;
+    }
+
+    // a boundary through a vertex would let a reflex vertex touch the line without crossing it, and the chunk
+    // closed along it would not be simple: one more pass moves every such boundary left, halfway to the
+    // nearest vertex before it, which keeps the vertices on it in the slab to its right as before
+    vector<char> on(bounds.size(), 0);
+    vector<double> before(bounds.size(), -INFINITY);
+    ooc_pass(poly, stats, [&](long long, double x, double) {
+        size_t k = lower_bound(bounds.begin(), bounds.end(), x) - bounds.begin();
+        if (k < bounds.size() && bounds[k] == x)
+        {
+            on[k] = 1;
+            k++;
+        }
+        if (k < bounds.size())
+        {
+            before[k] = max(before[k], x);
+        }
+    });
+    for (size_t k = 0; k < bounds.size(); k++)
+    {
+        double lo = max(before[k], k ? bounds[k - 1] : lox), mid = lo + (bounds[k] - lo) / 2;
+        if (on[k] && mid > lo && mid < bounds[k])
+        {
+            bounds[k] = mid;
+        }
+    }
+    return bounds;
+}
+/**
+ * @brief Decomposes the simple polygon of a binary coordinate file (see MappedCoords) into convex pieces and
+ * appends them to out as they are found, one line of ids per piece: positions in the file, or the ids of
+ * inserted points, which points receives as "id x y" lines.
+ *
+ * The polygon is cut by vertical lines through no vertex into slabs of at most opt.chunk vertices (see
+ * choose_slabs()). The parts of the lines inside the polygon are the cuts: one pass over the boundary records where it crosses them
+ * and the parts of it between two crossings. In every slab the crossings on each line are sorted by y, each
+ * interval inside the polygon joins a part that leaves the slab to one that enters it, and the closed chunks
+ * so found are split and merged in memory one at a time. Memory holds one chunk, the mapped window and one
+ * record per crossing; pieces are convex but are not merged across slabs.
+ *
+ * @param path the coordinate file, in either orientation
+ * @param opt chunk and window sizes
+ * @param out receives the pieces
+ * @param points receives the inserted points
+ * @return counters of the run
+ */
+OutOfCoreStats decompose_out_of_core(const string& path, const OutOfCoreOptions& opt, ostream& out, ostream& points)
+{
+    OutOfCoreStats stats = {0, 0, 0, 0, 0, 0};
+    MappedCoords coords(path, opt.window_bytes);
+    long long n = coords.size();
+    if (n < 3)
+    {
+        throw runtime_error("a polygon needs at least 3 vertices");
+    }
+    long long chunk = max(opt.chunk, 3LL);
+    OutOfCorePolygon poly = {&coords, n, false};
+
+    // orientation and extent; the shoelace sum is added up in blocks so that it stays accurate
+    double area = 0, block = 0, px = 0, py = 0, x0 = 0, y0 = 0, lox = INFINITY, hix = -INFINITY;
+    ooc_pass(poly, stats, [&](long long i, double x, double y) {
+        if (i == 0)
+        {
+            x0 = x;
+            y0 = y;
+        }
+        else
+        {
+            block += px * y - x * py;
+        }
+        if (i % 4096 == 0)
+        {
+            area += block;
+            block = 0;
+        }
+        lox = min(lox, x);
+        hix = max(hix, x);
+        px = x;
+        py = y;
+    });
+    area += block + px * y0 - x0 * py;
+    poly.reversed = area > 0;
+
+    auto whole = [&]() {
+        vector<double> xs(n), ys(n);
+        vector<long long> ids(n);
+        for (long long i = 0; i < n; i++)
+        {
+            poly.point(i, xs[i], ys[i]);
+            ids[i] = poly.id(i);
+        }
+        stats.slabs = stats.chunks = 1;
+        stats.oversized = n > chunk ? n : 0;
+        stats.pieces = decompose_chunk(xs, ys, ids, out);
+        return stats;
+    };
+    if (n <= chunk)
+    {
+        return whole();
+    }
+    vector<double> bounds = choose_slabs(poly, chunk, lox, hix, stats);
+    auto slab_of = [&](double x) { return (long long)(upper_bound(bounds.begin(), bounds.end(), x) - bounds.begin()); };
+
+    // the parts of the boundary in every slab; the one holding vertex 0 is closed at the end of the walk
+    vector<SlabChain> chains;
+    SlabChain cur;
+    cur.start = 0;
+    cur.count = 1;
+    long long su = 0, ui = 0;
+    double ux = 0, uy = 0;
+    // moves cur along the edge from vertex ui to vertex i at (x, y), which lies in slab s
+    auto walk_edge = [&](long long i, double x, double y, long long s) {
+        for (long long t = su; t != s; t += s > su ? 1 : -1)
+        {
+            bool right = s > su;
+            double b = bounds[right ? t : t - 1];
+            SlabPoint p;
+            if (ux == b)
+            {
+                p = {ux, uy, (y - uy) / (b - x), poly.id(ui)};
+            }
+            else if (x == b)
+            {
+                p = {x, y, (uy - y) / (b - ux), poly.id(i)};
+            }
+            else
+            {
+                p = {b, uy + (b - ux) * (y - uy) / (x - ux), 0, n + stats.inserted++};
+                points << p.id << " " << setprecision(17) << p.x << " " << p.y << "\n";
+            }
+            cur.exit = p;
+            cur.exit_left = !right;
+            chains.push_back(cur);
+            cur.slab = right ? t + 1 : t - 1;
+            cur.entry = p;
+            cur.entry_left = right;
+            cur.start = i;
+            cur.count = 0;
+        }
+    };
+    ooc_pass(poly, stats, [&](long long i, double x, double y) {
+        long long s = slab_of(x);
+        if (i == 0)
+        {
+            cur.slab = s;
+        }
+        else
+        {
+            walk_edge(i, x, y, s);
+            cur.count++;
+        }
+        su = s;
+        ux = x;
+        uy = y;
+        ui = i;
+    });
+    if (chains.empty())
+    {
+        return whole();
+    }
+    {
+        double x, y;
+        poly.point(0, x, y);
+        walk_edge(0, x, y, slab_of(x));
+        SlabChain &first = chains[0];
+        cur.exit = first.exit;
+        cur.exit_left = first.exit_left;
+        cur.count += first.count;
+        first = cur;
+    }
+    stats.slabs = bounds.size() + 1;
+
+    // close the chunks of every slab: on its left line the boundary leaves at the bottom of every interval
+    // inside the polygon and enters at its top, on its right line the other way round
+    vector<long long> by_slab(stats.slabs + 1, 0);
+    for (auto &c : chains)
+    {
+        by_slab[c.slab + 1]++;
+    }
+    partial_sum(by_slab.begin(), by_slab.end(), by_slab.begin());
+    vector<long long> order(chains.size()), fill_at(by_slab.begin(), by_slab.end() - 1);
+    for (long long k = 0; k < (long long)chains.size(); k++)
+    {
+        order[fill_at[chains[k].slab]++] = k;
+    }
+    struct LinePoint
+    {
+        double y, key;
+        bool entry;
+        long long chain;
+    };
+    vector<long long> next(chains.size(), -1);
+    vector<LinePoint> line;
+    vector<double> xs, ys;
+    vector<long long> ids;
+    for (long long s = 0; s < stats.slabs; s++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            bool left = side == 0;
+            line.clear();
+            for (long long k = by_slab[s]; k < by_slab[s + 1]; k++)
+            {
+                SlabChain &c = chains[order[k]];
+                if (c.entry_left == left)
+                {
+                    line.push_back({c.entry.y, c.entry.key, true, order[k]});
+                }
+                if (c.exit_left == left)
+                {
+                    line.push_back({c.exit.y, c.exit.key, false, order[k]});
+                }
+            }
+            sort(line.begin(), line.end(), [](const LinePoint& a, const LinePoint& b) {
+                return a.y != b.y ? a.y < b.y : a.key < b.key;
+            });
+            for (size_t k = 0; k + 1 < line.size(); k += 2)
+            {
+                LinePoint &lo = line[k], &hi = line[k + 1];
+                LinePoint &from = left ? lo : hi, &to = left ? hi : lo;
+                if (from.entry || !to.entry)
+                {
+                    throw runtime_error("the polygon is not simple");
+                }
+                next[from.chain] = to.chain;
+            }
+        }
+        for (long long k = by_slab[s]; k < by_slab[s + 1]; k++)
+        {
+            long long c = order[k];
+            if (next[c] < 0)
+            {
+                continue;
+            }
+            xs.clear();
+            ys.clear();
+            ids.clear();
+            auto add = [&](double x, double y, long long id) {
+                if (ids.empty() || ids.back() != id)
+                {
+                    xs.push_back(x);
+                    ys.push_back(y);
+                    ids.push_back(id);
+                }
+            };
+            while (next[c] >= 0)
+            {
+                SlabChain &ch = chains[c];
+                add(ch.entry.x, ch.entry.y, ch.entry.id);
+                for (long long v = 0; v < ch.count; v++)
+                {
+                    double x, y;
+                    long long i = (ch.start + v) % n;
+                    poly.point(i, x, y);
+                    add(x, y, poly.id(i));
+                }
+                add(ch.exit.x, ch.exit.y, ch.exit.id);
+                long long to = next[c];
+                next[c] = -1;
+                c = to;
+            }
+            if (ids.size() > 1 && ids.front() == ids.back())
+            {
+                xs.pop_back();
+                ys.pop_back();
+                ids.pop_back();
+            }
+            stats.oversized += (long long)ids.size() > chunk ? ids.size() : 0;
+            if (ids.size() >= 3 && signed_area(xs.data(), ys.data(), ids.size()) != 0)
+            {
+                stats.pieces += decompose_chunk(xs, ys, ids, out);
+                stats.chunks++;
+            }
+        }
+    }
+    return stats;
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file PerfCounters.hpp
+ * @brief Hardware performance counters of the calling thread through Linux perf_event_open.
+ *
+ * Only the benchmark runner uses them. Every counter is opened on its own, so a kernel or a container that
+ * lacks some of them (LLC and dTLB events are often missing in virtual machines, and perf_event_paranoid may
+ * forbid all of them) still gives the others; the ones that did not open read as -1.
+ */
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <bits/stdc++.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+/**
+ * @brief The counters PerfCounters reads, in the order of PerfCounters::Reading::value.
+ */
+enum PerfEvent
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENTS
+};
+/**
+ * @brief Names of the counters, as they are printed.
+ */
+const char* const PERF_EVENT_NAMES[PERF_EVENTS] = {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                                  "branch_misses", "dtlb_misses"};
+/**
+ * @brief A set of hardware counters of the calling thread, user space only.
+ * @class PerfCounters
+ *
+ * start() zeroes and enables the counters, stop() disables them and reads them. When the kernel multiplexes
+ * more counters than the PMU has, each value is scaled by the share of the time its counter was running.
+ */
+class PerfCounters
+{
+public:
+    struct Reading
+    {
+        long long value[PERF_EVENTS]; // count of every event, -1 when its counter is not available
+        double ipc() const;
+        double per(PerfEvent e, double n) const;
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;
+    string why_unavailable() const;
+    void start();
+    Reading stop();
+
+private:
+    int fd[PERF_EVENTS];
+    int error; // errno of the first counter that did not open, 0 if all did
+};
+/**
+ * @brief Instructions per cycle, or -1 when either counter is missing.
+ */
+double PerfCounters::Reading::ipc() const
+{
+    if (value[PERF_CYCLES] <= 0 || value[PERF_INSTRUCTIONS] < 0)
+    {
+        return -1;
+    }
+    return (double)value[PERF_INSTRUCTIONS] / value[PERF_CYCLES];
+}
+/**
+ * @brief Count of an event divided by n, such as misses per vertex, or -1 when its counter is missing.
+ */
+double PerfCounters::Reading::per(PerfEvent e, double n) const
+{
+    return value[e] < 0 ? -1 : value[e] / n;
+}
+/**
+ * @brief Opens the counters; those the kernel refuses stay closed.
+ */
+PerfCounters::PerfCounters()
+{
+    this->error = 0;
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        this->fd[e] = -1;
+    }
+#ifdef __linux__
+    auto cache = [](unsigned long long id, unsigned long long result) {
+        return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    };
+    const pair<unsigned int, unsigned long long> config[PERF_EVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    };
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = config[e].first;
+        attr.config = config[e].second;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        this->fd[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (this->fd[e] < 0 && !this->error)
+        {
+            this->error = errno;
+        }
+    }
+#else
+    this->error = ENOSYS;
+#endif
+}
+/**
+ * @brief Closes the counters.
+ */
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (this->fd[e] >= 0)
+        {
+            close(this->fd[e]);
+        }
+    }
+#endif
+}
+/**
+ * @brief Whether at least one counter is open.
+ */
+bool PerfCounters::available() const
+{
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (this->fd[e] >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+/**
+ * @brief Why some counter did not open, or an empty string if all did.
+ */
+string PerfCounters::why_unavailable() const
+{
+    if (!this->error)
+    {
+        return "";
+    }
+    string why = strerror(this->error);
+    if (this->error == EACCES || this->error == EPERM)
+    {
+        why += " (see /proc/sys/kernel/perf_event_paranoid, or the seccomp profile of the container)";
+    }
+    else if (this->error == ENOENT || this->error == EOPNOTSUPP)
+    {
+        why += " (the CPU or the hypervisor does not expose the event)";
+    }
+    return why;
+}
+/**
+ * @brief Zeroes and enables the open counters.
+ */
+void PerfCounters::start()
+{
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (this->fd[e] >= 0)
+        {
+            ioctl(this->fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(this->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+/**
+ * @brief Disables the open counters and reads them.
+ *
+ * @return the counts since start(), -1 for counters that are not open or could not be read
+ */
+PerfCounters::Reading PerfCounters::stop()
+{
+    Reading r;
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        r.value[e] = -1;
+    }
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (this->fd[e] >= 0)
+        {
+            ioctl(this->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        unsigned long long buf[3]; // value, time enabled, time running
+        if (this->fd[e] < 0 || read(this->fd[e], buf, sizeof buf) != sizeof buf)
+        {
+            continue;
+        }
+        if (buf[2] == 0)
+        {
+            // the counter never got onto the PMU
+            r.value[e] = buf[1] == 0 ? 0 : -1;
+        }
+        else
+        {
+            r.value[e] = buf[2] < buf[1] ? (long long)((double)buf[0] * buf[1] / buf[2]) : (long long)buf[0];
+        }
+    }
+#endif
+    return r;
+}
+
+#endif
@@ -0,0 +1,267 @@
+/**
+ * @file PointLocation.hpp
+ * @brief Point location over the convex pieces left by DCEL::merge.
+ *
+ */
+#ifndef POINTLOCATION_H
+#define POINTLOCATION_H
+
+#include <bits/stdc++.h>
+#include <thread>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Answers "which convex piece contains this point" for a merged DCEL.
+ * @class PointLocator
+ *
+ * The pieces are put in a bounding box hierarchy split at the median of the box centres. A query walks the
+ * boxes that contain the point and, at the leaves, tests the point against each convex piece with a binary
+ * search over the fan from its first vertex, so every test is O(log k) for a piece with k vertices.
+ * The locator copies the coordinates it needs and does not keep the DCEL around after construction.
+ */
+class PointLocator
+{
+public:
+    /**
+     * @brief Vertex ids of every piece, in the order of the input polygon. Queries return indices into it.
+     */
+    vector<vector<int>> pieces;
+
+    PointLocator(DCEL* dcel);
+    int locate(double x, double y) const;
+    void locate(const double* xs, const double* ys, int* out, size_t count, int threads) const;
+
+private:
+    struct Node
+    {
+        double xmin, xmax, ymin, ymax;
+        int left, right;  // children, -1 for a leaf
+        int first, count; // range of order[] for a leaf
+    };
+    static constexpr int LEAF_SIZE = 4;
+    vector<double> px, py;     // vertices of every piece, counter clockwise, one piece after the other
+    vector<int> start;         // piece k is px/py[start[k] .. start[k+1])
+    vector<double> bxmin, bxmax, bymin, bymax;
+    vector<int> order;         // piece ids in leaf order
+    vector<Node> nodes;
+
+    int build(int lo, int hi);
+    bool contains(int k, double x, double y) const;
+};
+/**
+ * @brief Builds the locator over the faces of a DCEL on which merge() has already been run.
+ *
+ * @param dcel the merged DCEL
+ */
+PointLocator::PointLocator(DCEL* dcel)
+{
+    auto faces = dcel->convex_faces();
+    int k = faces.size();
+    this->start.push_back(0);
+    for (auto &f : faces)
+    {
+        double area = 0;
+        int m = f.size();
+        for (int i = 0; i < m; i++)
+        {
+            Vertex* a = f[i];
+            Vertex* b = f[(i + 1) % m];
+            area += a->x * b->y - b->x * a->y;
+        }
+        vector<int> ids;
+        for (auto v : f)
+        {
+            ids.push_back(v->id);
+        }
+        this->pieces.push_back(ids);
+        if (area < 0)
+        {
+            reverse(f.begin(), f.end());
+        }
+        double xmin = f[0]->x, xmax = xmin, ymin = f[0]->y, ymax = ymin;
+        for (auto v : f)
+        {
+            this->px.push_back(v->x);
+            this->py.push_back(v->y);
+            xmin = min(xmin, v->x); xmax = max(xmax, v->x);
+            ymin = min(ymin, v->y); ymax = max(ymax, v->y);
+        }
+        this->start.push_back(this->px.size());
+        this->bxmin.push_back(xmin); this->bxmax.push_back(xmax);
+        this->bymin.push_back(ymin); this->bymax.push_back(ymax);
+    }
+    for (int i = 0; i < k; i++)
+    {
+        this->order.push_back(i);
+    }
+    if (k)
+    {
+        this->build(0, k);
+    }
+}
+/**
+ * @brief Builds the node covering order[lo..hi) and its children.
+ *
+ * @return index of the node
+ */
+int PointLocator::build(int lo, int hi)
+{
+    Node nd;
+    nd.xmin = this->bxmin[this->order[lo]]; nd.xmax = this->bxmax[this->order[lo]];
+    nd.ymin = this->bymin[this->order[lo]]; nd.ymax = this->bymax[this->order[lo]];
+    for (int i = lo + 1; i < hi; i++)
+    {
+        int p = this->order[i];
+        nd.xmin = min(nd.xmin, this->bxmin[p]); nd.xmax = max(nd.xmax, this->bxmax[p]);
+        nd.ymin = min(nd.ymin, this->bymin[p]); nd.ymax = max(nd.ymax, this->bymax[p]);
+    }
+    nd.left = nd.right = -1;
+    nd.first = lo;
+    nd.count = hi - lo;
+    int id = this->nodes.size();
+    this->nodes.push_back(nd);
+    if (hi - lo <= LEAF_SIZE)
+    {
+        return id;
+    }
+    // split the longer side at the median of the box centres
+    bool alongx = nd.xmax - nd.xmin >= nd.ymax - nd.ymin;
+    int mid = (lo + hi) / 2;
+    nth_element(this->order.begin() + lo, this->order.begin() + mid, this->order.begin() + hi, [&](int a, int b) {
+        if (alongx)
+        {
+            return this->bxmin[a] + this->bxmax[a] < this->bxmin[b] + this->bxmax[b];
+        }
+        return this->bymin[a] + this->bymax[a] < this->bymin[b] + this->bymax[b];
+    });
+    int l = this->build(lo, mid);
+    int r = this->build(mid, hi);
+    this->nodes[id].left = l;
+    this->nodes[id].right = r;
+    this->nodes[id].count = 0;
+    return id;
+}
+/**
+ * @brief Checks whether a point lies in a convex piece, boundary included.
+ *
+ * @param k index of the piece
+ * @param x x-coordinate of the point
+ * @param y y-coordinate of the point
+ * @return true if the point is inside the piece or on its boundary.
+ * @return false otherwise.
+ */
+bool PointLocator::contains(int k, double x, double y) const
+{
+    int s = this->start[k];
+    int m = this->start[k + 1] - s;
+    if (m < 3)
+    {
+        return false;
+    }
+    const double* X = this->px.data() + s;
+    const double* Y = this->py.data() + s;
+    double qx = x - X[0], qy = y - Y[0];
+    // q has to be between the rays p0->p1 and p0->p(m-1)
+    if ((X[1] - X[0]) * qy - (Y[1] - Y[0]) * qx < 0)
+    {
+        return false;
+    }
+    if ((X[m - 1] - X[0]) * qy - (Y[m - 1] - Y[0]) * qx > 0)
+    {
+        return false;
+    }
+    // last fan edge p0->p(lo) with q on its left
+    int lo = 1, hi = m - 1;
+    while (hi - lo > 1)
+    {
+        int mid = (lo + hi) / 2;
+        if ((X[mid] - X[0]) * qy - (Y[mid] - Y[0]) * qx >= 0)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return (X[lo + 1] - X[lo]) * (y - Y[lo]) - (Y[lo + 1] - Y[lo]) * (x - X[lo]) >= 0;
+}
+/**
+ * @brief Finds the convex piece containing a point.
+ *
+ * @param x x-coordinate of the point
+ * @param y y-coordinate of the point
+ * @return index of the piece in pieces, or -1 if the point is outside the polygon
+ */
+int PointLocator::locate(double x, double y) const
+{
+    if (this->nodes.empty())
+    {
+        return -1;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top)
+    {
+        const Node &nd = this->nodes[stack[--top]];
+        if (x < nd.xmin || x > nd.xmax || y < nd.ymin || y > nd.ymax)
+        {
+            continue;
+        }
+        if (nd.left < 0)
+        {
+            for (int i = nd.first; i < nd.first + nd.count; i++)
+            {
+                int p = this->order[i];
+                if (x >= this->bxmin[p] && x <= this->bxmax[p] && y >= this->bymin[p] && y <= this->bymax[p] && this->contains(p, x, y))
+                {
+                    return p;
+                }
+            }
+        }
+        else
+        {
+            stack[top++] = nd.right;
+            stack[top++] = nd.left;
+        }
+    }
+    return -1;
+}
+/**
+ * @brief Locates a batch of points, splitting it between threads.
+ *
+ * @param xs x-coordinates of the points
+ * @param ys y-coordinates of the points
+ * @param out receives the index of the piece of every point, -1 for points outside the polygon
+ * @param count number of points
+ * @param threads number of threads to use, at least 1
+ */
+void PointLocator::locate(const double* xs, const double* ys, int* out, size_t count, int threads) const
+{
+    threads = max(1, threads);
+    auto work = [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++)
+        {
+            out[i] = this->locate(xs[i], ys[i]);
+        }
+    };
+    if (threads == 1)
+    {
+        work(0, count);
+        return;
+    }
+    vector<thread> pool;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++)
+    {
+        size_t lo = min(count, t * chunk), hi = min(count, lo + chunk);
+        pool.emplace_back(work, lo, hi);
+    }
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+}
+
+#endif
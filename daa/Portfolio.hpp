@@ -0,0 +1,117 @@
+/**
+ * @file Portfolio.hpp
+ * @brief Runs split and merge from several start vertices in parallel and keeps the best decomposition.
+ *
+ */
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <bits/stdc++.h>
+#include <thread>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Outcome of portfolio_decompose().
+ */
+struct PortfolioResult
+{
+    DCEL* dcel;        // merged DCEL of the best run, owned by the caller
+    int start;         // start vertex of that run
+    int m;             // number of diagonals its split() added
+    int pieces;        // number of convex pieces it has
+    int runs;          // runs that finished
+    bool deadline_hit; // whether the deadline stopped the portfolio or cut a split() short
+    vector<pair<int,int>> diags; // diagonals of the best run, for DCEL::replay_split
+    vector<bool> removed;        // which of them its merge() removed, for DCEL::replay_merge
+};
+/**
+ * @brief Decomposes a polygon from k start vertices spread evenly over it, on up to threads threads, and keeps
+ * the run with the fewest pieces (the lowest start on a tie, so the choice does not depend on timing).
+ *
+ * Every run builds its own DCEL from the coordinates of source, which are only read. With a deadline, runs that
+ * have not started when it passes are skipped, and the split() of the others gets the time that is left as its
+ * budget (see DCEL::split_budget_ms), so every run ends close to the deadline; at least one run always finishes.
+ *
+ * @param source a DCEL built with DCEL::build() and not split yet; it is left untouched
+ * @param k number of start vertices
+ * @param threads number of threads
+ * @param deadline_ms time limit in milliseconds, 0 for none
+ * @return the best run
+ */
+PortfolioResult portfolio_decompose(DCEL* source, int k, int threads, double deadline_ms)
+{
+    int n = source->vertices.size();
+    k = max(1, min(k, n));
+    threads = max(1, min(threads, k));
+    auto begin = chrono::steady_clock::now();
+    auto deadline = begin + chrono::duration<double, milli>(deadline_ms);
+
+    mutex mu;
+    PortfolioResult best = {NULL, 0, 0, 0, 0, false, {}, {}};
+    atomic<int> next(0);
+    auto work = [&]() {
+        int r;
+        while ((r = next++) < k)
+        {
+            double left = 0;
+            if (deadline_ms > 0)
+            {
+                left = chrono::duration<double, milli>(deadline - chrono::steady_clock::now()).count();
+                lock_guard<mutex> lock(mu);
+                if (left <= 0 && best.dcel)
+                {
+                    best.deadline_hit = true;
+                    return;
+                }
+            }
+            DCEL* d = new DCEL(n);
+            for (int i = 0; i < n; i++)
+            {
+                d->vertices[i] = new Vertex(i, source->vertices[i]->x, source->vertices[i]->y, NULL);
+            }
+            d->link_edges();
+            d->input_id = source->input_id;
+            d->verbose = false;
+            d->split_start = (long long)r * n / k;
+            // a run that starts after the deadline still needs some budget to finish
+            d->split_budget_ms = deadline_ms > 0 ? max(left, 1e-3) : 0;
+            int m = 0;
+            d->split(n, m);
+            d->merge(n, m);
+            int pieces = d->convex_faces().size();
+            lock_guard<mutex> lock(mu);
+            best.runs++;
+            best.deadline_hit = best.deadline_hit || d->budget_hit;
+            if (!best.dcel || pieces < best.pieces || (pieces == best.pieces && d->split_start < best.start))
+            {
+                delete best.dcel;
+                best.dcel = d;
+                best.start = d->split_start;
+                best.m = m;
+                best.pieces = pieces;
+            }
+            else
+            {
+                delete d;
+            }
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+    {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+    for (auto e : best.dcel->LLE)
+    {
+        best.diags.push_back({e->twin->org->id, e->org->id});
+        best.removed.push_back(!e->isrequired);
+    }
+    return best;
+}
+
+#endif
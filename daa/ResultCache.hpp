@@ -0,0 +1,239 @@
+/**
+ * @file ResultCache.hpp
+ * @brief On-disk cache of decompositions, keyed by the canonical form of the input polygon.
+ *
+ */
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <bits/stdc++.h>
+#include <filesystem>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Cache of the diagonals split() and merge() produce for a polygon.
+ * @class ResultCache
+ *
+ * Polygons are first put in canonical form by canonical_order(): clockwise, the orientation split() expects,
+ * and starting from the lexicographically smallest vertex. The key is a hash of the canonical coordinates, so the
+ * same polygon submitted with another start vertex or the other orientation finds the same entry. An entry
+ * holds the diagonals in the order split() added them and which of them merge() removed, which is enough for
+ * DCEL::replay_split and DCEL::replay_merge to rebuild the final DCEL in O(n).
+ *
+ * Every entry is a file of the cache directory; a hit refreshes its modification time and store() removes the
+ * least recently used entries once the directory grows beyond the size limit. The counters are kept in the
+ * file "stats" of the directory, so they add up over runs.
+ */
+class ResultCache
+{
+public:
+    long long hits, misses, evictions;
+
+    ResultCache(string dir, long long limit);
+    static vector<int> canonical_order(const vector<double>& xs, const vector<double>& ys);
+    bool lookup(DCEL* d, vector<pair<int,int>>& diags, vector<bool>& removed);
+    void store(DCEL* d);
+
+private:
+    string dir;
+    long long limit;
+    static unsigned long long hash(DCEL* d, unsigned long long seed);
+    string path(DCEL* d);
+    void save_stats();
+    void evict();
+};
+/**
+ * @brief Opens (and creates if needed) a cache directory.
+ *
+ * @param dir the cache directory
+ * @param limit maximum total size of the entries in bytes
+ */
+ResultCache::ResultCache(string dir, long long limit)
+{
+    this->dir = dir;
+    this->limit = limit;
+    this->hits = this->misses = this->evictions = 0;
+    filesystem::create_directories(dir);
+    ifstream st(dir + "/stats");
+    st >> this->hits >> this->misses >> this->evictions;
+}
+/**
+ * @brief Gives the order in which the vertices have to be taken to get the canonical form of a polygon.
+ *
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @return order[i] is the index in the input of the i-th canonical vertex
+ */
+vector<int> ResultCache::canonical_order(const vector<double>& xs, const vector<double>& ys)
+{
+    int n = xs.size();
+    double area = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int j = (i + 1) % n;
+        area += xs[i] * ys[j] - xs[j] * ys[i];
+    }
+    vector<int> order(n);
+    for (int i = 0; i < n; i++)
+    {
+        order[i] = area > 0 ? (n - i) % n : i;
+    }
+    int first = 0;
+    for (int i = 1; i < n; i++)
+    {
+        int a = order[i], b = order[first];
+        if (xs[a] < xs[b] || (xs[a] == xs[b] && ys[a] < ys[b]))
+        {
+            first = i;
+        }
+    }
+    rotate(order.begin(), order.begin() + first, order.end());
+    return order;
+}
+/**
+ * @brief Hash of the vertex coordinates of a DCEL.
+ */
+unsigned long long ResultCache::hash(DCEL* d, unsigned long long seed)
+{
+    unsigned long long h = seed ^ (d->vertices.size() * 0x9E3779B97F4A7C15ULL);
+    for (auto v : d->vertices)
+    {
+        for (double c : {v->x, v->y})
+        {
+            unsigned long long bits;
+            memcpy(&bits, &c, sizeof bits);
+            h = (h ^ bits) * 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 31;
+        }
+    }
+    return h;
+}
+/**
+ * @brief Path of the entry of a DCEL.
+ */
+string ResultCache::path(DCEL* d)
+{
+    char name[32];
+    snprintf(name, sizeof name, "%016llx.dcc", ResultCache::hash(d, 1));
+    return this->dir + "/" + name;
+}
+/**
+ * @brief Looks a polygon up. The DCEL has to be built from the canonical order of its vertices.
+ *
+ * @param d the DCEL, before split()
+ * @param diags receives the diagonals to pass to DCEL::replay_split
+ * @param removed receives the flags to pass to DCEL::replay_merge
+ * @return true on a hit.
+ * @return false on a miss.
+ */
+bool ResultCache::lookup(DCEL* d, vector<pair<int,int>>& diags, vector<bool>& removed)
+{
+    string p = this->path(d);
+    ifstream in(p, ios::binary);
+    unsigned int magic = 0, n = 0, m = 0;
+    unsigned long long check = 0;
+    in.read((char*)&magic, 4);
+    in.read((char*)&n, 4);
+    in.read((char*)&check, 8);
+    in.read((char*)&m, 4);
+    bool hit = in && magic == 0x31434344 && n == d->vertices.size() && check == ResultCache::hash(d, 2);
+    // a damaged entry can hold any count: a polygon has fewer diagonals than vertices, and they have to be in
+    // the file, before anything is allocated for them
+    error_code ec;
+    unsigned long long size = filesystem::file_size(p, ec);
+    hit = hit && !ec && m <= n && 20 + 8ULL * m <= size;
+    if (hit)
+    {
+        vector<unsigned int> raw(2 * (size_t)m);
+        in.read((char*)raw.data(), raw.size() * 4);
+        hit = bool(in);
+        diags.clear();
+        removed.clear();
+        for (unsigned int j = 0; j < m && hit; j++)
+        {
+            unsigned int f = raw[2 * j], b = raw[2 * j + 1] & 0x7fffffff;
+            hit = f < n && b < n;
+            diags.push_back({f, b});
+            removed.push_back(raw[2 * j + 1] >> 31);
+        }
+    }
+    if (hit)
+    {
+        this->hits++;
+        filesystem::last_write_time(p, filesystem::file_time_type::clock::now(), ec);
+    }
+    else
+    {
+        this->misses++;
+    }
+    this->save_stats();
+    return hit;
+}
+/**
+ * @brief Stores the result of a DCEL on which split() and merge() have been run.
+ *
+ * @param d the merged DCEL, built from the canonical order of its vertices
+ */
+void ResultCache::store(DCEL* d)
+{
+    unsigned int magic = 0x31434344, n = d->vertices.size(), m = d->LLE.size();
+    unsigned long long check = ResultCache::hash(d, 2);
+    vector<unsigned int> raw;
+    for (auto e : d->LLE)
+    {
+        raw.push_back(e->twin->org->id);
+        raw.push_back(e->org->id | (e->isrequired ? 0u : 1u << 31));
+    }
+    string p = this->path(d);
+    string tmp = p + ".tmp";
+    {
+        ofstream out(tmp, ios::binary);
+        out.write((char*)&magic, 4);
+        out.write((char*)&n, 4);
+        out.write((char*)&check, 8);
+        out.write((char*)&m, 4);
+        out.write((char*)raw.data(), raw.size() * 4);
+    }
+    error_code ec;
+    filesystem::rename(tmp, p, ec);
+    this->evict();
+    this->save_stats();
+}
+/**
+ * @brief Removes the least recently used entries until the cache fits in its size limit.
+ */
+void ResultCache::evict()
+{
+    vector<pair<filesystem::file_time_type, filesystem::path>> entries;
+    long long total = 0;
+    error_code ec;
+    for (auto &f : filesystem::directory_iterator(this->dir, ec))
+    {
+        if (f.path().extension() == ".dcc")
+        {
+            total += f.file_size(ec);
+            entries.push_back({f.last_write_time(ec), f.path()});
+        }
+    }
+    sort(entries.begin(), entries.end());
+    for (auto &e : entries)
+    {
+        if (total <= this->limit)
+        {
+            break;
+        }
+        total -= filesystem::file_size(e.second, ec);
+        filesystem::remove(e.second, ec);
+        this->evictions++;
+    }
+}
+/**
+ * @brief Writes the counters to the stats file of the cache directory.
+ */
+void ResultCache::save_stats()
+{
+    ofstream st(this->dir + "/stats");
+    st << this->hits << " " << this->misses << " " << this->evictions << "\n";
+}
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * @file Simplify.hpp
+ * @brief Tolerance based simplification of the input polygon, run before the DCEL is built.
+ *
+ */
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include <bits/stdc++.h>
+using namespace std;
+/**
+ * @brief Distance of point p from the segment ab.
+ */
+double segment_distance(double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx - ax, dy = by - ay;
+    double len = dx * dx + dy * dy;
+    double t = len > 0 ? ((px - ax) * dx + (py - ay) * dy) / len : 0;
+    t = max(0.0, min(1.0, t));
+    double ex = ax + t * dx - px, ey = ay + t * dy - py;
+    return sqrt(ex * ex + ey * ey);
+}
+/**
+ * @brief Sign of the cross product (b - a) x (c - a).
+ */
+int orientation(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double v = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    return (v > 0) - (v < 0);
+}
+/**
+ * @brief Checks whether the segments pq and rs touch or cross.
+ */
+bool segments_meet(double px, double py, double qx, double qy, double rx, double ry, double sx, double sy)
+{
+    int o1 = orientation(px, py, qx, qy, rx, ry);
+    int o2 = orientation(px, py, qx, qy, sx, sy);
+    int o3 = orientation(rx, ry, sx, sy, px, py);
+    int o4 = orientation(rx, ry, sx, sy, qx, qy);
+    if (o1 != o2 && o3 != o4)
+    {
+        return true;
+    }
+    auto on = [](double ax, double ay, double bx, double by, double cx, double cy) {
+        return min(ax, bx) <= cx && cx <= max(ax, bx) && min(ay, by) <= cy && cy <= max(ay, by);
+    };
+    return (o1 == 0 && on(px, py, qx, qy, rx, ry)) || (o2 == 0 && on(px, py, qx, qy, sx, sy)) ||
+           (o3 == 0 && on(rx, ry, sx, sy, px, py)) || (o4 == 0 && on(rx, ry, sx, sy, qx, qy));
+}
+/**
+ * @brief Checks that the polygon through the given vertices is simple: no two edges that are not consecutive
+ * touch. The edges are swept in order of their smallest x, so only edges whose x-ranges overlap are compared.
+ *
+ * @param xs x-coordinates of all the vertices
+ * @param ys y-coordinates of all the vertices
+ * @param idx indices of the vertices of the polygon, in order
+ * @return true if the polygon is simple.
+ * @return false otherwise.
+ */
+bool is_simple(const vector<double>& xs, const vector<double>& ys, const vector<int>& idx)
+{
+    int m = idx.size();
+    if (m < 3)
+    {
+        return false;
+    }
+    vector<int> seg(m);
+    iota(seg.begin(), seg.end(), 0);
+    auto lo = [&](int i) { return min(xs[idx[i]], xs[idx[(i + 1) % m]]); };
+    auto hi = [&](int i) { return max(xs[idx[i]], xs[idx[(i + 1) % m]]); };
+    sort(seg.begin(), seg.end(), [&](int a, int b) { return lo(a) < lo(b); });
+    vector<int> active;
+    for (int s : seg)
+    {
+        double x = lo(s);
+        int keep = 0;
+        for (int a : active)
+        {
+            if (hi(a) >= x)
+            {
+                active[keep++] = a;
+            }
+        }
+        active.resize(keep);
+        for (int a : active)
+        {
+            if ((a + 1) % m == s || (s + 1) % m == a)
+            {
+                continue;
+            }
+            int p = idx[s], q = idx[(s + 1) % m], r = idx[a], t = idx[(a + 1) % m];
+            if (segments_meet(xs[p], ys[p], xs[q], ys[q], xs[r], ys[r], xs[t], ys[t]))
+            {
+                return false;
+            }
+        }
+        active.push_back(s);
+    }
+    return true;
+}
+/**
+ * @brief Douglas-Peucker simplification of a closed polygon.
+ *
+ * The ring is cut at vertex 0 and at the vertex farthest from it, and each of the two chains is reduced so that
+ * no dropped vertex is farther than tol from the simplified chain. Collinear vertices are dropped even for tol = 0.
+ *
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @param idx indices of the vertices of the polygon, in order
+ * @param tol the tolerance
+ * @return the indices that are kept, in order
+ */
+vector<int> douglas_peucker(const vector<double>& xs, const vector<double>& ys, const vector<int>& idx, double tol)
+{
+    int m = idx.size();
+    if (m <= 3)
+    {
+        return idx;
+    }
+    int far = 1;
+    double best = -1;
+    for (int i = 1; i < m; i++)
+    {
+        double dx = xs[idx[i]] - xs[idx[0]], dy = ys[idx[i]] - ys[idx[0]];
+        if (dx * dx + dy * dy > best)
+        {
+            best = dx * dx + dy * dy;
+            far = i;
+        }
+    }
+    vector<bool> keep(m, false);
+    keep[0] = keep[far] = true;
+    // chains as (first, last) positions in idx, last may be m for the closing vertex 0
+    vector<pair<int, int>> stack = {{0, far}, {far, m}};
+    while (stack.size())
+    {
+        auto [a, b] = stack.back();
+        stack.pop_back();
+        int pa = idx[a], pb = idx[b % m];
+        int split = -1;
+        double dmax = tol;
+        for (int i = a + 1; i < b; i++)
+        {
+            double d = segment_distance(xs[idx[i]], ys[idx[i]], xs[pa], ys[pa], xs[pb], ys[pb]);
+            if (d > dmax)
+            {
+                dmax = d;
+                split = i;
+            }
+        }
+        if (split >= 0)
+        {
+            keep[split] = true;
+            stack.push_back({a, split});
+            stack.push_back({split, b});
+        }
+    }
+    vector<int> res;
+    for (int i = 0; i < m; i++)
+    {
+        if (keep[i])
+        {
+            res.push_back(idx[i]);
+        }
+    }
+    return res;
+}
+/**
+ * @brief Drops the vertices closer than tol to the previous vertex that is kept, and the last ones closer than
+ * tol to the first.
+ *
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @param tol the tolerance
+ * @return the indices that are kept, in order
+ */
+vector<int> drop_repeated(const vector<double>& xs, const vector<double>& ys, double tol)
+{
+    int n = xs.size();
+    vector<int> idx;
+    for (int i = 0; i < n; i++)
+    {
+        if (idx.size())
+        {
+            int p = idx.back();
+            if (hypot(xs[i] - xs[p], ys[i] - ys[p]) <= tol)
+            {
+                continue;
+            }
+        }
+        idx.push_back(i);
+    }
+    while (idx.size() > 3 && hypot(xs[idx.back()] - xs[idx[0]], ys[idx.back()] - ys[idx[0]]) <= tol)
+    {
+        idx.pop_back();
+    }
+    return idx;
+}
+/**
+ * @brief Simplifies a polygon: drops repeated vertices (closer than tol to the previous kept one) with
+ * drop_repeated(), then collinear and nearly collinear vertices with douglas_peucker(). Either step can make
+ * the outline cross itself, across a narrow neck for instance, so when the result is not a simple polygon both
+ * are tried again with half the tolerance; after a few failures the polygon is returned as it is.
+ *
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @param tol the tolerance, in the units of the coordinates
+ * @return the indices of the vertices that are kept, in order; they map the simplified polygon back to the input
+ */
+vector<int> simplify_polygon(const vector<double>& xs, const vector<double>& ys, double tol)
+{
+    int n = xs.size();
+    for (int attempt = 0; attempt < 6; attempt++, tol /= 2)
+    {
+        vector<int> res = douglas_peucker(xs, ys, drop_repeated(xs, ys, tol), tol);
+        if (res.size() >= 3 && is_simple(xs, ys, res))
+        {
+            return res;
+        }
+    }
+    vector<int> all(n);
+    iota(all.begin(), all.end(), 0);
+    return all;
+}
+
+#endif
@@ -0,0 +1,590 @@
+/**
+ * @file SmallPolygon.hpp
+ * @brief Allocation-free split and merge for polygons with a small, compile-time bounded number of vertices.
+ *
+ */
+#ifndef SMALLPOLYGON_H
+#define SMALLPOLYGON_H
+
+#include <bits/stdc++.h>
+using namespace std;
+/**
+ * @brief Polygons with at most this many vertices are decomposed by SmallPolygon inside DCEL.
+ *
+ */
+const int SMALL_POLYGON_LIMIT = 16;
+/**
+ * @brief Calls f(i) for every i of the sequence, one call after the other in the generated code.
+ */
+template <class F, int... I>
+inline void unrolled(F&& f, integer_sequence<int, I...>)
+{
+    (f(I), ...);
+}
+/**
+ * @brief Calls f(0), ..., f(K - 1), unrolled at compile time: the loops of SmallPolygon that run over its
+ * capacity rather than over a count found at run time use it, so they have no loop counter or branch back, and
+ * every index is a constant the compiler can fold into the addressing.
+ *
+ * @tparam K number of calls
+ * @param f the body, taking the index
+ */
+template <int K, class F>
+inline void unrolled(F&& f)
+{
+    unrolled(f, make_integer_sequence<int, K>());
+}
+/**
+ * @brief Fixed-capacity version of DCEL::split and DCEL::merge working on index arrays.
+ * @class SmallPolygon
+ *
+ * Half-edges are stored in plain arrays with the same layout the DCEL uses: edges 0..n-1 are the polygon
+ * edges, n..2n-1 their (unlinked) twins, and every diagonal adds a pair (diag, rev) after that. All the
+ * pointer updates of DCEL::split and DCEL::merge are mirrored on those indices, so the diagonals produced
+ * and the ones removed are exactly the ones the general path would give, without touching the heap.
+ *
+ * @tparam N maximum number of vertices
+ */
+template <int N>
+class SmallPolygon
+{
+public:
+    static constexpr int MAXD = N;           // capacity for diagonals
+    static constexpr int MAXE = 2 * N + 2 * MAXD;
+    static constexpr int MAXF = MAXD + 2;
+
+    int n;
+    double x[N], y[N];
+    // half-edges
+    int org[MAXE], nxt[MAXE], prv[MAXE], twin[MAXE], face[MAXE];
+    // incident half-edge of each vertex
+    int inc[N];
+    // diagonals in the order they were added (LLE), index of diag half-edge
+    int diag[MAXD];
+    bool removed[MAXD];
+    int m;
+    // faces
+    int finc[MAXF];
+    int nf;
+
+    void load(const double *xs, const double *ys, int n);
+    bool split();
+    bool merge();
+
+    /**
+     * @brief Same test as isreflex(), on coordinates. atan2(b, a) < 0 is evaluated on the signs directly.
+     */
+    static bool reflex(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        double x1 = bx - ax;
+        double y1 = by - ay;
+        double x2 = bx - cx;
+        double y2 = by - cy;
+        double a = x1 * x2 + y1 * y2;
+        double b = x1 * y2 - x2 * y1;
+        return b < 0 || (b == 0 && signbit(b) && signbit(a));
+    }
+    /**
+     * @brief iscollinear(), on coordinates.
+     */
+    static bool collinear(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        return (bx - ax) * (cy - ay) - (cx - ax) * (by - ay) == 0;
+    }
+    /**
+     * @brief liesbetween(), on coordinates: whether v lies on the segment from a to b, strictly between its ends.
+     */
+    static bool between(double vx, double vy, double ax, double ay, double bx, double by)
+    {
+        double x1 = bx - ax;
+        double y1 = by - ay;
+        double x2 = vx - ax;
+        double y2 = vy - ay;
+        double dot = x1 * x2 + y1 * y2;
+        return x1 * y2 - x2 * y1 == 0 && dot > 0 && dot < x1 * x1 + y1 * y1;
+    }
+    /**
+     * @brief leavesinside(), on coordinates.
+     */
+    static bool leaves_inside(double ax, double ay, double bx, double by, double cx, double cy, double px,
+                              double py)
+    {
+        double ux = ax - bx, uy = ay - by;
+        double wx = cx - bx, wy = cy - by;
+        double dx = px - bx, dy = py - by;
+        double wd = wx * dy - wy * dx;
+        double du = dx * uy - dy * ux;
+        if (ux * wy - uy * wx >= 0)
+        {
+            return wd < 0 && du < 0;
+        }
+        return wd < 0 || du < 0;
+    }
+
+private:
+    // working state of split(), indexed by vertex id where noted
+    int P[N], psz, head;
+    int pos[N];      // position of vertex in P
+    int L[N], lsz;
+    int LPVS[N], qsz;
+    int inL[N];      // epoch stamp: vertex is in L when inL[v] == epoch
+    int epoch;
+
+    bool reflex_v(int a, int b, int c) const
+    {
+        return reflex(x[a], y[a], x[b], y[b], x[c], y[c]);
+    }
+    int succ(int v) const
+    {
+        int p = pos[v] + 1;
+        return P[p == psz ? 0 : p];
+    }
+    int pred(int v) const
+    {
+        int p = pos[v];
+        return P[p == 0 ? psz - 1 : p - 1];
+    }
+    bool collinear_v(int a, int b, int c) const
+    {
+        return collinear(x[a], y[a], x[b], y[b], x[c], y[c]);
+    }
+    bool leaves_inside_v(int a, int b, int c, int d) const
+    {
+        return leaves_inside(x[a], y[a], x[b], y[b], x[c], y[c], x[d], y[d]);
+    }
+    bool isnotch(int v) const
+    {
+        int e = this->inc[v];
+        return reflex_v(this->org[this->prv[e]], v, this->org[this->twin[e]]);
+    }
+    bool inside_L(int v) const;
+    bool same_side(int v1, int v2, int v3, int v4) const;
+    int next_vertex(int f, int v) const;
+    int prev_vertex(int f, int v) const;
+};
+/**
+ * @brief Loads the polygon and builds the initial boundary cycle.
+ *
+ * @param xs x-coordinates of the vertices
+ * @param ys y-coordinates of the vertices
+ * @param n number of vertices, at most N
+ */
+template <int N>
+void SmallPolygon<N>::load(const double *xs, const double *ys, int n)
+{
+    this->n = n;
+    this->m = 0;
+    this->nf = 0;
+    unrolled<N>([&](int i) {
+        if (i < n)
+        {
+            int t = n + i;
+            int j = i + 1 == n ? 0 : i + 1;
+            this->x[i] = xs[i];
+            this->y[i] = ys[i];
+            this->org[i] = i;
+            this->org[t] = j;
+            this->twin[i] = t;
+            this->twin[t] = i;
+            this->nxt[i] = j;
+            this->prv[j] = i;
+            this->nxt[t] = this->prv[t] = -1;
+            this->face[i] = this->face[t] = -1;
+            this->inc[i] = i;
+        }
+    });
+}
+/**
+ * @brief Vertex::isInsidePolygon against the current L.
+ */
+template <int N>
+bool SmallPolygon<N>::inside_L(int v) const
+{
+    double px = this->x[v], py = this->y[v];
+    for (int i = 0; i < lsz; i++)
+    {
+        int a = L[i];
+        int b = L[i + 1 == lsz ? 0 : i + 1];
+        double res = (x[b] - x[a]) * (py - y[a]) - (px - x[a]) * (y[b] - y[a]);
+        if (res >= 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/**
+ * @brief lieonsameside() on vertex ids.
+ */
+template <int N>
+bool SmallPolygon<N>::same_side(int v1, int v2, int v3, int v4) const
+{
+    double c = x[v1] * y[v2] - x[v2] * y[v1];
+    double y21 = y[v2] - y[v1];
+    double x21 = x[v2] - x[v1];
+    double val1 = x[v3] * y21 - y[v3] * x21;
+    double val2 = x[v4] * y21 - y[v4] * x21;
+    return (val1 - c) * (val2 - c) > 0;
+}
+/**
+ * @brief next_vertex() on the index half-edges. Returns -1 if v is not on the face.
+ */
+template <int N>
+int SmallPolygon<N>::next_vertex(int f, int v) const
+{
+    int e = this->finc[f];
+    int e1 = e;
+    int guard = 0;
+    do
+    {
+        e1 = this->nxt[e1];
+        if (this->org[e1] == v)
+        {
+            return this->org[this->nxt[e1]];
+        }
+    } while (e1 != e && ++guard < MAXE);
+    return -1;
+}
+/**
+ * @brief prev_vertex() on the index half-edges. Returns -1 if v is not on the face.
+ */
+template <int N>
+int SmallPolygon<N>::prev_vertex(int f, int v) const
+{
+    int e = this->finc[f];
+    int e1 = e;
+    int guard = 0;
+    do
+    {
+        e1 = this->prv[e1];
+        if (this->org[e1] == v)
+        {
+            return this->org[this->prv[e1]];
+        }
+    } while (e1 != e && ++guard < MAXE);
+    return -1;
+}
+/**
+ * @brief MP1 split of DCEL::split, step for step, on fixed arrays.
+ *
+ * @return true on success.
+ * @return false if the run left the cases the general path handles (capacity exceeded or a degenerate
+ * chain); the caller should then fall back to DCEL::split.
+ */
+template <int N>
+bool SmallPolygon<N>::split()
+{
+    int n = this->n;
+    // Step 1; the entries past n are never read
+    unrolled<N>([&](int i) {
+        P[i] = i;
+        pos[i] = i;
+        inL[i] = 0;
+    });
+    psz = n;
+    head = 0;
+    epoch = 0;
+    // Step 2
+    int sz = n;
+    L[0] = 0;
+    lsz = 1;
+    // Step 3
+    while (sz > 3)
+    {
+        // 3.1
+        int v1 = L[lsz - 1];
+        int v2 = succ(v1);
+        // 3.2
+        ++epoch;
+        L[0] = v1;
+        L[1] = v2;
+        lsz = 2;
+        inL[v1] = inL[v2] = epoch;
+        int va = v1, vb = v2, vc = succ(vb);
+        // 3.3
+        while (!reflex_v(va, vb, vc) and !reflex_v(vb, vc, v1) and !reflex_v(vc, v1, v2) and !collinear_v(v1, vb, vc) and lsz < sz)
+        {
+            L[lsz++] = vc;
+            inL[vc] = epoch;
+            va = vb;
+            vb = vc;
+            vc = succ(vc);
+        }
+        // 3.4
+        if (lsz != psz)
+        {
+            // 3.4.1
+            qsz = 0;
+            for (int i = 0; i < psz; i++)
+            {
+                int p = P[(head + i) % psz];
+                if (inL[p] != epoch and isnotch(p))
+                {
+                    LPVS[qsz++] = p;
+                }
+            }
+            // 3.4.2
+            int qh = 0;
+            while (qh < qsz)
+            {
+                if (lsz == 0)
+                {
+                    return false;
+                }
+                double xmin = x[L[0]], xmax = xmin, ymin = y[L[0]], ymax = ymin;
+                for (int i = 1; i < lsz; i++)
+                {
+                    xmin = min(xmin, x[L[i]]); xmax = max(xmax, x[L[i]]);
+                    ymin = min(ymin, y[L[i]]); ymax = max(ymax, y[L[i]]);
+                }
+                bool backward = false;
+                while (!backward and qh < qsz)
+                {
+                    int k = 0;
+                    for (int i = qh; i < qsz; i++)
+                    {
+                        int v = LPVS[i];
+                        if (x[v] >= xmin && x[v] <= xmax && y[v] >= ymin && y[v] <= ymax)
+                        {
+                            LPVS[k++] = v;
+                        }
+                    }
+                    qh = 0;
+                    qsz = k;
+                    if (qsz)
+                    {
+                        int v = LPVS[qh];
+                        if (inside_L(v))
+                        {
+                            int last = L[lsz - 1];
+                            int keep = 0;
+                            for (int i = 0; i < lsz; i++)
+                            {
+                                if (L[i] != v1 && (same_side(v1, v, L[i], last) || collinear_v(v1, v, L[i])))
+                                {
+                                    inL[L[i]] = epoch - 1;
+                                }
+                                else
+                                {
+                                    L[keep++] = L[i];
+                                }
+                            }
+                            lsz = keep;
+                            backward = true;
+                        }
+                        else if (between(x[v], y[v], x[L[lsz - 1]], y[L[lsz - 1]], x[v1], y[v1]))
+                        {
+                            inL[L[--lsz]] = epoch - 1;
+                            backward = true;
+                        }
+                        qh++;
+                    }
+                }
+            }
+        }
+        // 3.4.3
+        if (lsz != psz)
+        {
+            int before_v1 = pred(v1);
+            while (lsz > 2 && !(leaves_inside_v(L[lsz - 2], L[lsz - 1], succ(L[lsz - 1]), v1) &&
+                                leaves_inside_v(before_v1, v1, v2, L[lsz - 1])))
+            {
+                inL[L[--lsz]] = epoch - 1;
+            }
+        }
+        // 3.5
+        if (lsz > 2)
+        {
+            int Front = L[0];
+            int Back = L[lsz - 1];
+            if (Front == Back)
+            {
+                return false;
+            }
+            if (this->org[this->prv[this->inc[Front]]] != Back)
+            {
+                // 3.5.1
+                if (this->m == MAXD)
+                {
+                    return false;
+                }
+                int d = 2 * n + 2 * this->m;
+                int r = d + 1;
+                this->org[d] = Back;
+                this->org[r] = Front;
+                this->twin[d] = r;
+                this->twin[r] = d;
+                int ea = this->inc[Front];
+                int eaprevold = this->prv[ea];
+                int eb = this->inc[Back];
+                int ebprevold = this->prv[eb];
+                this->nxt[d] = ea;
+                this->prv[ea] = d;
+                this->nxt[r] = eb;
+                this->prv[eb] = r;
+                this->prv[d] = ebprevold;
+                this->nxt[ebprevold] = d;
+                this->prv[r] = eaprevold;
+                this->nxt[eaprevold] = r;
+                this->face[d] = this->face[r] = -1;
+                this->finc[this->nf++] = d;
+                this->inc[Front] = r;
+                this->diag[this->m] = d;
+                this->removed[this->m] = false;
+                this->m++;
+            }
+            // 3.5.2
+            int k = 0;
+            int Q[N];
+            for (int i = 0; i < psz; i++)
+            {
+                int p = P[(head + i) % psz];
+                if (inL[p] != epoch or p == Front or p == Back)
+                {
+                    Q[k++] = p;
+                }
+            }
+            for (int i = 0; i < k; i++)
+            {
+                P[i] = Q[i];
+                pos[Q[i]] = i;
+            }
+            psz = k;
+            head = 0;
+            sz = sz - lsz + 2;
+        }
+        else
+        {
+            head = (head + 1) % psz;
+            L[0] = v1;
+            L[1] = v2;
+            lsz = 2;
+        }
+    }
+    // faces of the pieces
+    for (int f = 0; f < this->nf; f++)
+    {
+        int e = this->finc[f];
+        int dup = e;
+        int guard = 0;
+        do
+        {
+            this->face[dup] = f;
+            dup = this->nxt[dup];
+        } while (dup != e && ++guard < MAXE);
+    }
+    // remaining face, first from the polygon edges and diagonals, then from the reversed diagonals
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int tt = -1;
+        if (pass == 0)
+        {
+            for (int i = 0; i < n && tt < 0; i++)
+            {
+                if (this->face[i] < 0)
+                {
+                    tt = i;
+                }
+            }
+        }
+        for (int j = 0; j < this->m && tt < 0; j++)
+        {
+            int e = 2 * n + 2 * j + pass;
+            if (this->face[e] < 0)
+            {
+                tt = e;
+            }
+        }
+        if (tt >= 0)
+        {
+            if (this->nf == MAXF)
+            {
+                return false;
+            }
+            int f = this->nf++;
+            this->finc[f] = tt;
+            int t1 = tt;
+            int guard = 0;
+            do
+            {
+                this->face[t1] = f;
+                t1 = this->nxt[t1];
+            } while (t1 != tt && ++guard < MAXE);
+        }
+    }
+    return true;
+}
+/**
+ * @brief Merge step of DCEL::merge on the index half-edges. Sets removed[j] for every dropped diagonal.
+ *
+ * @return true on success.
+ * @return false if a diagonal was left without a face; the caller should then fall back to DCEL::merge.
+ */
+template <int N>
+bool SmallPolygon<N>::merge()
+{
+    int n = this->n;
+    // LPV sizes: number of faces in which v is followed by a non adjacent id
+    int lpv[N], seen[N], after[N];
+    unrolled<N>([&](int v) {
+        lpv[v] = 0;
+        seen[v] = -1;
+    });
+    for (int f = 0; f < this->nf; f++)
+    {
+        int e = this->finc[f];
+        int dup = e;
+        int guard = 0;
+        do
+        {
+            dup = this->nxt[dup];
+            seen[this->org[dup]] = f;
+            after[this->org[dup]] = this->org[this->nxt[dup]];
+        } while (dup != e && ++guard < MAXE);
+        unrolled<N>([&](int v) { lpv[v] += v < n && seen[v] == f && abs(after[v] - v) != 1; });
+    }
+    bool convex[N];
+    unrolled<N>([&](int v) {
+        if (v < n)
+        {
+            convex[v] = !reflex_v(v == 0 ? n - 1 : v - 1, v, v + 1 == n ? 0 : v + 1);
+        }
+    });
+    for (int j = 0; j < this->m; j++)
+    {
+        int d = this->diag[j];
+        int r = this->twin[d];
+        int vs = this->org[d];
+        int vt = this->org[r];
+        if ((lpv[vs] > 2 && lpv[vt] > 2) || (lpv[vs] > 2 && convex[vt]) || (lpv[vt] > 2 && convex[vs]) || (convex[vt] && convex[vs]))
+        {
+            if (this->face[d] < 0 || this->face[r] < 0)
+            {
+                return false;
+            }
+            int j3 = next_vertex(this->face[d], vt);
+            int i1 = prev_vertex(this->face[d], vs);
+            int j1 = prev_vertex(this->face[r], vt);
+            int i3 = next_vertex(this->face[r], vs);
+            if (j3 < 0 || i1 < 0 || j1 < 0 || i3 < 0)
+            {
+                return false;
+            }
+            if (!reflex_v(i1, vs, i3) && !reflex_v(j1, vt, j3))
+            {
+                int ea = this->prv[d];
+                int ec = this->nxt[d];
+                int eb = this->nxt[r];
+                int ed = this->prv[r];
+                this->nxt[ea] = eb;
+                this->prv[eb] = ea;
+                this->prv[ec] = ed;
+                this->nxt[ed] = ec;
+                this->removed[j] = true;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
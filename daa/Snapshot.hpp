@@ -0,0 +1,289 @@
+/**
+ * @file Snapshot.hpp
+ * @brief Binary snapshot of a DCEL after split(), to run merge() again without splitting.
+ *
+ */
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <bits/stdc++.h>
+#include "DCEL.hpp"
+using namespace std;
+/**
+ * @brief Magic number at the start of a snapshot file, "DCS1".
+ */
+const unsigned int SNAPSHOT_MAGIC = 0x31534344;
+/*
+ * Layout of a snapshot, all numbers in native byte order. Half-edge h < E is edges[h], h >= E is
+ * twin_edges[h - E]; -1 stands for NULL.
+ *
+ *   header      uint32 magic, n, E, F, L, m, has_input_id
+ *   vertices    double x[n], y[n]; int32 id[n], inc_edge[n], out_start[n + 1], out[out_start[n]]
+ *   half-edges  int32 twin[2E], next[2E], prev[2E], org[2E], right[2E]; uint8 isrequired[2E]
+ *   faces       int32 id[F], inc_edge[F], parent[F]
+ *   diagonals   int32 LLE[L]
+ *   input ids   int32 input_id[n], only when has_input_id
+ */
+
+template <class T>
+void snapshot_write(ofstream& out, const vector<T>& v)
+{
+    out.write((const char*)v.data(), v.size() * sizeof(T));
+}
+
+template <class T>
+bool snapshot_read(ifstream& in, vector<T>& v, size_t count)
+{
+    v.resize(count);
+    in.read((char*)v.data(), count * sizeof(T));
+    return bool(in);
+}
+/**
+ * @brief Writes the DCEL as it is after split() (or after merge()) to a file.
+ *
+ * @param d the DCEL
+ * @param m number of diagonals split() reported
+ * @param path the file to write
+ * @return true if the file was written.
+ * @return false otherwise.
+ */
+bool save_snapshot(DCEL* d, int m, const string& path)
+{
+    int n = d->vertices.size(), E = d->edges.size(), F = d->faces.size(), L = d->LLE.size();
+    unordered_map<Edge*, int> eid;
+    unordered_map<Face*, int> fid;
+    eid.reserve(2 * E);
+    fid.reserve(F);
+    for (int i = 0; i < E; i++)
+    {
+        eid[d->edges[i]] = i;
+        eid[d->twin_edges[i]] = E + i;
+    }
+    for (int i = 0; i < F; i++)
+    {
+        fid[d->faces[i]] = i;
+    }
+    auto e_of = [&](Edge* e) { return e ? eid.at(e) : -1; };
+    auto f_of = [&](Face* f) { return f ? fid.at(f) : -1; };
+
+    vector<double> x(n), y(n);
+    vector<int> vid(n), vinc(n), ostart(n + 1, 0), out;
+    for (int i = 0; i < n; i++)
+    {
+        Vertex* v = d->vertices[i];
+        x[i] = v->x;
+        y[i] = v->y;
+        vid[i] = v->id;
+        vinc[i] = e_of(v->inc_edge);
+        for (auto e : v->out)
+        {
+            out.push_back(e_of(e));
+        }
+        ostart[i + 1] = out.size();
+    }
+    vector<int> twin(2 * E), next(2 * E), prev(2 * E), org(2 * E), right(2 * E);
+    vector<unsigned char> req(2 * E);
+    for (int h = 0; h < 2 * E; h++)
+    {
+        Edge* e = h < E ? d->edges[h] : d->twin_edges[h - E];
+        twin[h] = e_of(e->twin);
+        next[h] = e_of(e->next);
+        prev[h] = e_of(e->prev);
+        org[h] = e->org ? e->org->id : -1;
+        right[h] = f_of(e->right);
+        req[h] = e->isrequired;
+    }
+    vector<int> fids(F), finc(F), fparent(F), lle(L);
+    for (int i = 0; i < F; i++)
+    {
+        fids[i] = d->faces[i]->id;
+        finc[i] = e_of(d->faces[i]->inc_edge);
+        fparent[i] = f_of(d->faces[i]->parent);
+    }
+    for (int j = 0; j < L; j++)
+    {
+        lle[j] = e_of(d->LLE[j]);
+    }
+
+    ofstream file(path, ios::binary);
+    unsigned int header[7] = {SNAPSHOT_MAGIC, (unsigned)n, (unsigned)E, (unsigned)F, (unsigned)L, (unsigned)m,
+                              (unsigned)!d->input_id.empty()};
+    file.write((const char*)header, sizeof header);
+    for (auto v : {&x, &y})
+    {
+        snapshot_write(file, *v);
+    }
+    for (auto v : {&vid, &vinc, &ostart, &out, &twin, &next, &prev, &org, &right})
+    {
+        snapshot_write(file, *v);
+    }
+    snapshot_write(file, req);
+    for (auto v : {&fids, &finc, &fparent, &lle})
+    {
+        snapshot_write(file, *v);
+    }
+    if (!d->input_id.empty())
+    {
+        snapshot_write(file, d->input_id);
+    }
+    return bool(file);
+}
+/**
+ * @brief Loads a snapshot written by save_snapshot() in O(n): every object is allocated first, then all the
+ * pointers are set from the stored indices in one pass per array.
+ *
+ * merge() on the loaded DCEL always runs the general algorithm, since the small polygon state is not saved.
+ *
+ * @param path the file to read
+ * @param m receives the number of diagonals
+ * @return the DCEL, or NULL if the file is missing or not a valid snapshot, truncated or corrupt included
+ */
+DCEL* load_snapshot(const string& path, int& m)
+{
+    ifstream file(path, ios::binary);
+    unsigned int header[7] = {0};
+    file.read((char*)header, sizeof header);
+    if (!file || header[0] != SNAPSHOT_MAGIC)
+    {
+        return NULL;
+    }
+    // the counts of a corrupt file can be anything, so they are checked against the size of the file before
+    // anything is allocated with them
+    long long size = file.seekg(0, ios::end).tellg();
+    file.seekg(sizeof header);
+    long long counts = max({header[1], header[2], header[3], header[4]});
+    size_t per_vertex = 2 * sizeof(double) + (header[6] ? 4 : 3) * sizeof(int);
+    long long need = sizeof header + header[1] * per_vertex + sizeof(int) + 2LL * header[2] * (5 * sizeof(int) + 1) +
+                     3LL * header[3] * sizeof(int) + header[4] * sizeof(int);
+    if (!file || counts > INT_MAX / 2 || need > size)
+    {
+        return NULL;
+    }
+    int n = header[1], E = header[2], F = header[3], L = header[4];
+    vector<double> x, y;
+    vector<int> vid, vinc, ostart, out, twin, next, prev, org, right, fids, finc, fparent, lle, input_id;
+    vector<unsigned char> req;
+    bool ok = snapshot_read(file, x, n) && snapshot_read(file, y, n) && snapshot_read(file, vid, n) &&
+              snapshot_read(file, vinc, n) && snapshot_read(file, ostart, n + 1) && ostart[0] == 0 &&
+              is_sorted(ostart.begin(), ostart.end()) && ostart[n] <= (size - need) / (long long)sizeof(int) &&
+              snapshot_read(file, out, ostart[n]);
+    for (auto v : {&twin, &next, &prev, &org, &right})
+    {
+        ok = ok && snapshot_read(file, *v, 2 * E);
+    }
+    ok = ok && snapshot_read(file, req, 2 * E);
+    ok = ok && snapshot_read(file, fids, F) && snapshot_read(file, finc, F) && snapshot_read(file, fparent, F) &&
+         snapshot_read(file, lle, L);
+    ok = ok && (!header[6] || snapshot_read(file, input_id, n));
+    // every stored index has to be in range before it is turned into a pointer; -1 (NULL) is allowed for
+    // half-edges and faces, but every half-edge has an origin and every vertex an id
+    auto in_range = [&](const vector<int>& v, int lo, int hi) {
+        return all_of(v.begin(), v.end(), [&](int i) { return i >= lo && i < hi; });
+    };
+    ok = ok && in_range(vinc, -1, 2 * E) && in_range(out, -1, 2 * E) && in_range(twin, -1, 2 * E) &&
+         in_range(next, -1, 2 * E) && in_range(prev, -1, 2 * E) && in_range(org, 0, n) && in_range(right, -1, F) &&
+         in_range(finc, -1, 2 * E) && in_range(fparent, -1, F) && in_range(lle, -1, 2 * E) && in_range(vid, 0, n);
+    if (!ok)
+    {
+        return NULL;
+    }
+
+    DCEL* d = new DCEL(n);
+    d->edges.resize(E);
+    d->twin_edges.resize(E);
+    d->faces.resize(F);
+    vector<Edge*> he(2 * E);
+    for (int i = 0; i < n; i++)
+    {
+        d->vertices[i] = new Vertex(vid[i], x[i], y[i], NULL);
+    }
+    for (int h = 0; h < 2 * E; h++)
+    {
+        he[h] = new Edge(NULL, NULL, NULL, NULL, NULL);
+        (h < E ? d->edges[h] : d->twin_edges[h - E]) = he[h];
+    }
+    for (int i = 0; i < F; i++)
+    {
+        d->faces[i] = new Face(NULL, fids[i]);
+    }
+    auto edge_at = [&](int i) { return i < 0 ? (Edge*)NULL : he[i]; };
+    auto face_at = [&](int i) { return i < 0 ? (Face*)NULL : d->faces[i]; };
+    for (int i = 0; i < n; i++)
+    {
+        Vertex* v = d->vertices[i];
+        v->inc_edge = edge_at(vinc[i]);
+        for (int k = ostart[i]; k < ostart[i + 1]; k++)
+        {
+            v->out.push_back(edge_at(out[k]));
+        }
+    }
+    for (int h = 0; h < 2 * E; h++)
+    {
+        Edge* e = he[h];
+        e->twin = edge_at(twin[h]);
+        e->next = edge_at(next[h]);
+        e->prev = edge_at(prev[h]);
+        e->org = d->vertices[org[h]];
+        e->right = face_at(right[h]);
+        e->isrequired = req[h];
+    }
+    for (int i = 0; i < F; i++)
+    {
+        d->faces[i]->inc_edge = edge_at(finc[i]);
+        d->faces[i]->parent = face_at(fparent[i]);
+    }
+    for (int j = 0; j < L; j++)
+    {
+        d->LLE.push_back(edge_at(lle[j]));
+    }
+    d->input_id = input_id;
+    d->use_small_path = false;
+    m = header[5];
+    return d;
+}
+
+/**
+ * @brief Magic number at the start of a pieces file, "DCP1".
+ */
+const unsigned int PIECES_MAGIC = 0x31504344;
+/*
+ * Layout of a pieces file, all numbers in native byte order, written after compact(). Piece k is faces[k].
+ *
+ *   header      uint32 magic, k, total
+ *   pieces      int32 offset[k + 1], input_id[total]; piece i is input_id[offset[i] .. offset[i + 1]), clockwise
+ *   attributes  double area[k], cx[k], cy[k], minx[k], miny[k], maxx[k], maxy[k]
+ */
+/**
+ * @brief Writes the convex pieces of a compacted DCEL and their attributes (see DCEL::compact()) to a file.
+ *
+ * @param d the DCEL, after merge() and compact()
+ * @param path the file to write
+ * @return true if the file was written.
+ * @return false otherwise.
+ */
+bool save_pieces(DCEL* d, const string& path)
+{
+    vector<int> offset = {0}, ids;
+    for (auto &face : d->convex_faces())
+    {
+        for (auto v : face)
+        {
+            ids.push_back(d->source_id(v));
+        }
+        offset.push_back(ids.size());
+    }
+    int k = offset.size() - 1;
+    ofstream out(path, ios::binary);
+    unsigned int header[3] = {PIECES_MAGIC, (unsigned int)k, (unsigned int)ids.size()};
+    out.write((const char*)header, sizeof header);
+    snapshot_write(out, offset);
+    snapshot_write(out, ids);
+    for (auto c : {&d->face_area, &d->face_cx, &d->face_cy, &d->face_minx, &d->face_miny, &d->face_maxx,
+                   &d->face_maxy})
+    {
+        snapshot_write(out, *c);
+    }
+    return bool(out);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file SpscQueue.hpp
+ * @brief Bounded lock-free queue between one producer thread and one consumer thread.
+ *
+ */
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <bits/stdc++.h>
+#include <thread>
+using namespace std;
+/**
+ * @brief Ring buffer of a fixed capacity with one writer and one reader.
+ * @class SpscQueue
+ *
+ * The producer only writes tail and the consumer only writes head, each on its own cache line, so push and pop
+ * need no lock: an acquire load of the other index is enough to see the slot it published. push() waits while
+ * the queue is full, which is what gives a pipeline its backpressure; pop() waits while it is empty until the
+ * producer calls close().
+ */
+template <class T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity);
+    bool try_push(T &v);
+    bool try_pop(T &v);
+    void push(T v);
+    bool pop(T &v);
+    void close();
+
+private:
+    vector<T> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head; // next slot to pop, written by the consumer
+    alignas(64) atomic<size_t> tail; // next slot to push, written by the producer
+    alignas(64) atomic<bool> closed;
+};
+/**
+ * @brief Creates an empty queue.
+ *
+ * @param capacity number of slots, rounded up to a power of two
+ */
+template <class T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+{
+    size_t c = 1;
+    while (c < max<size_t>(capacity, 2))
+    {
+        c *= 2;
+    }
+    this->slots.resize(c);
+    this->mask = c - 1;
+    this->head = 0;
+    this->tail = 0;
+    this->closed = false;
+}
+/**
+ * @brief Adds an item if there is room, moving from v.
+ *
+ * @return true if it was added.
+ * @return false if the queue is full.
+ */
+template <class T>
+bool SpscQueue<T>::try_push(T &v)
+{
+    size_t t = this->tail.load(memory_order_relaxed);
+    if (t - this->head.load(memory_order_acquire) > this->mask)
+    {
+        return false;
+    }
+    this->slots[t & this->mask] = move(v);
+    this->tail.store(t + 1, memory_order_release);
+    return true;
+}
+/**
+ * @brief Takes the oldest item if there is one.
+ *
+ * @return true if v received an item.
+ * @return false if the queue is empty.
+ */
+template <class T>
+bool SpscQueue<T>::try_pop(T &v)
+{
+    size_t h = this->head.load(memory_order_relaxed);
+    if (h == this->tail.load(memory_order_acquire))
+    {
+        return false;
+    }
+    v = move(this->slots[h & this->mask]);
+    this->head.store(h + 1, memory_order_release);
+    return true;
+}
+/**
+ * @brief Adds an item, waiting while the queue is full.
+ */
+template <class T>
+void SpscQueue<T>::push(T v)
+{
+    while (!this->try_push(v))
+    {
+        this_thread::yield();
+    }
+}
+/**
+ * @brief Takes the oldest item, waiting while the queue is empty.
+ *
+ * @return true if v received an item.
+ * @return false if the queue is empty and closed.
+ */
+template <class T>
+bool SpscQueue<T>::pop(T &v)
+{
+    while (!this->try_pop(v))
+    {
+        if (this->closed.load(memory_order_acquire))
+        {
+            // items pushed before close() are visible once closed is
+            return this->try_pop(v);
+        }
+        this_thread::yield();
+    }
+    return true;
+}
+/**
+ * @brief Tells the consumer that no more items will come. Called by the producer.
+ */
+template <class T>
+void SpscQueue<T>::close()
+{
+    this->closed.store(true, memory_order_release);
+}
+
+#endif
@@ -24,10 +24,12 @@ class Vertex
     Edge *inc_edge;
     int id;
     double x, y;
+    vector<Edge *> out; // half-edges leaving this vertex, one per face around it
     
     Vertex(int num, double x, double y, Edge *e);
     bool isnotch();
-    bool isInsidePolygon(deque<Vertex *> vertices);
+    Edge *outgoing(Face *f);
+    bool isInsidePolygon(const deque<Vertex *>& vertices);
     bool isinRect(double xmin, double xmax, double ymin, double ymax);
    
 };
@@ -74,31 +76,39 @@ bool Vertex::isnotch()
         return false;
 
 }
+/**
+ * @brief Gives the half-edge leaving this vertex in a face, in O(number of diagonals at the vertex).
+ * 
+ * @param f the face, possibly merged into another one since
+ * @return the half-edge, or NULL if the vertex is not on the face
+ */
+Edge *Vertex::outgoing(Face *f)
+{
+    Face *target = f->find();
+    for (auto e : this->out)
+    {
+        if (e->isrequired && e->twin->isrequired && e->right && e->right->find() == target)
+        {
+            return e;
+        }
+    }
+    return NULL;
+}
 /**
  * @brief Checks whether a vertex is inside the polygon
  * 
- * @param vertices a deque of vertices representing the polygon
+ * @param vertices a deque of vertices representing the polygon, read in place
  * @return true if the vertex is inside the polygon.
  * @return false if the vertex is not inside the polygon.
  */
-bool Vertex::isInsidePolygon(deque<Vertex *> vertices)
+bool Vertex::isInsidePolygon(const deque<Vertex *>& vertices)
 {
-    auto start = vertices.front();
     int n = vertices.size();
     double x = this->x, y = this->y;
-    Vertex *v2;
     for (int i{}; i < n; i++)
     {
-        auto v1 = vertices.front();
-        vertices.pop_front();
-        if (i == n - 1)
-        {
-            v2 = start;
-        }
-        else
-        {
-            v2 = vertices.front();
-        }
+        Vertex *v1 = vertices[i];
+        Vertex *v2 = vertices[i + 1 == n ? 0 : i + 1];
         double x_cap1 = v2->x - v1->x;
         double y_cap1 = v2->y - v1->y;
         double x_cap2 = x - v1->x, y_cap2 = y - v1->y;
@@ -114,6 +124,7 @@ bool Vertex::isInsidePolygon(deque<Vertex *> vertices)
  * @brief Checks whether a vertex is in rectangle or not
  * 
  * The vertices in rectangle found using this boolean function are checked whether they are convex or not and then returns in the set.
+ * Its border counts as inside, so that a vertex on a diagonal along it is checked too.
  * @param xmax The maximum x-coordinate of the rectangular region.
  * @param xmin The minimum x-coordinate of the rectangular region.
  * @param ymin The minimum y-coordinate of the rectangular region.
@@ -123,7 +134,7 @@ bool Vertex::isInsidePolygon(deque<Vertex *> vertices)
  */
 bool Vertex:: isinRect(double xmin, double xmax, double ymin, double ymax)
 {
-    return this->x > xmin && this->x < xmax && this->y > ymin && this->y < ymax;
+    return this->x >= xmin && this->x <= xmax && this->y >= ymin && this->y <= ymax;
 }
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 /**
  * @file actoc.cpp
  * @brief This file reverses the order of vertices
+ * 
+ * main.cpp no longer needs it: DCEL::build detects a counter clockwise input and reverses it in place.
  */
 #include <bits/stdc++.h>
 using namespace std;
@@ -0,0 +1,381 @@
+/**
+ * @file adversary.cpp
+ * @brief Searches for simple polygons on which split() and merge() do the most work per vertex.
+ *
+ * Build with g++ -O2 adversary.cpp -o adversary and run
+ *     ./adversary [--objective iterations|failed|backtracks|time] [--n N] [--max-n N] [--seconds S]
+ *                 [--seed S] [--start star|spiral] [--keep K] [--corpus DIR]
+ *
+ * A hill climb mutates a simple polygon by moving a vertex (jitter), pushing a new vertex into an edge (notch)
+ * or twisting the vertices around their centroid (spiral winding), and keeps any simple mutant that scores at
+ * least as high. The score is the chosen counter of the last split() (see DCEL::split_iterations) per vertex,
+ * or the time of split() and merge() per vertex. The climb restarts from a fresh polygon when it stalls.
+ *
+ * The K worst polygons found go to DIR (corpus/ by default) in the format of input.txt, as
+ * <objective>-<rank>.txt, with their scores in DIR/index.txt; ./bench corpus DIR replays them. The polygon under
+ * evaluation is kept in DIR/pending.txt until it finishes, so a shape that crashes split() is not lost, and
+ * split() runs with an iteration budget of 50 n, so one that makes it loop scores as high as it can.
+ */
+#include <bits/stdc++.h>
+#include <chrono>
+#include <filesystem>
+#include "DCEL.hpp"
+#include "Simplify.hpp"
+
+using namespace std;
+/**
+ * @brief A polygon, clockwise.
+ */
+struct Shape
+{
+    vector<double> xs, ys;
+};
+/**
+ * @brief Work split() and merge() did on one polygon.
+ */
+struct Effort
+{
+    long long iterations, failed, backtracks;
+    double us_per_vertex;
+    bool budget_hit;
+};
+/**
+ * @brief Random clockwise star shaped polygon, like gen.py and bench.cpp make.
+ */
+Shape star_shape(int n, mt19937 &rng)
+{
+    uniform_real_distribution<double> jitter(0.1, 0.9), radius(100, 250);
+    Shape s;
+    for (int i = 0; i < n; i++)
+    {
+        double ang = 2 * M_PI * (n - i - jitter(rng)) / n;
+        double r = radius(rng);
+        s.xs.push_back(r * cos(ang));
+        s.ys.push_back(r * sin(ang));
+    }
+    return s;
+}
+/**
+ * @brief Clockwise spiral band: n / 2 vertices on an outer Archimedean spiral and n / 2 coming back on an inner
+ * one, a long chain of notches.
+ */
+Shape spiral_shape(int n, mt19937 &rng)
+{
+    uniform_real_distribution<double> turns(1.5, 3.5);
+    double t = turns(rng) * 2 * M_PI;
+    int h = max(n / 2, 2);
+    Shape s;
+    for (int i = 0; i < h; i++)
+    {
+        double a = t * i / (h - 1), r = 20 + 12 * a;
+        s.xs.push_back(r * cos(-a));
+        s.ys.push_back(r * sin(-a));
+    }
+    for (int i = h - 1; i >= 0; i--)
+    {
+        double a = t * i / (h - 1), r = 14 + 12 * a;
+        s.xs.push_back(r * cos(-a));
+        s.ys.push_back(r * sin(-a));
+    }
+    if (signed_area(s.xs.data(), s.ys.data(), s.xs.size()) > 0)
+    {
+        reverse(s.xs.begin(), s.xs.end());
+        reverse(s.ys.begin(), s.ys.end());
+    }
+    return s;
+}
+/**
+ * @brief Applies one random mutation.
+ *
+ * @param max_n vertices a notch may grow the polygon to; at the limit a vertex is dropped first
+ */
+Shape mutate(const Shape &s, int max_n, mt19937 &rng)
+{
+    Shape m = s;
+    int n = m.xs.size();
+    uniform_real_distribution<double> u(0, 1);
+    normal_distribution<double> g(0, 1);
+    int kind = rng() % 3;
+    if (kind == 0)
+    {
+        // jitter a vertex by a fraction of its edges
+        int i = rng() % n, p = (i + n - 1) % n, q = (i + 1) % n;
+        double len = (hypot(m.xs[i] - m.xs[p], m.ys[i] - m.ys[p]) + hypot(m.xs[q] - m.xs[i], m.ys[q] - m.ys[i])) / 2;
+        m.xs[i] += 0.3 * len * g(rng);
+        m.ys[i] += 0.3 * len * g(rng);
+    }
+    else if (kind == 1)
+    {
+        // notch: a new vertex in an edge, pushed inwards (to the right of the edge, the polygon is clockwise)
+        if (n >= max_n)
+        {
+            int d = rng() % n;
+            m.xs.erase(m.xs.begin() + d);
+            m.ys.erase(m.ys.begin() + d);
+            n--;
+        }
+        int i = rng() % n, j = (i + 1) % n;
+        double dx = m.xs[j] - m.xs[i], dy = m.ys[j] - m.ys[i], t = 0.2 + 0.6 * u(rng), depth = 0.5 * u(rng);
+        m.xs.insert(m.xs.begin() + i + 1, m.xs[i] + t * dx + depth * dy);
+        m.ys.insert(m.ys.begin() + i + 1, m.ys[i] + t * dy - depth * dx);
+    }
+    else
+    {
+        // spiral winding: turn every vertex around the centroid by an angle growing with its distance
+        double cx = accumulate(m.xs.begin(), m.xs.end(), 0.0) / n, cy = accumulate(m.ys.begin(), m.ys.end(), 0.0) / n;
+        double rmax = 0;
+        for (int i = 0; i < n; i++)
+        {
+            rmax = max(rmax, hypot(m.xs[i] - cx, m.ys[i] - cy));
+        }
+        double w = 0.4 * g(rng);
+        for (int i = 0; i < n; i++)
+        {
+            double x = m.xs[i] - cx, y = m.ys[i] - cy, a = w * hypot(x, y) / rmax;
+            m.xs[i] = cx + x * cos(a) - y * sin(a);
+            m.ys[i] = cy + x * sin(a) + y * cos(a);
+        }
+    }
+    return m;
+}
+/**
+ * @brief Whether a polygon is simple and clockwise, so that DCEL::build() takes it as it is.
+ */
+bool valid_shape(const Shape &s)
+{
+    int n = s.xs.size();
+    vector<int> idx(n);
+    iota(idx.begin(), idx.end(), 0);
+    return n >= 4 && signed_area(s.xs.data(), s.ys.data(), n) < 0 && is_simple(s.xs, s.ys, idx);
+}
+/**
+ * @brief Writes a polygon in the format of input.txt.
+ */
+void write_shape(const Shape &s, const string &path)
+{
+    ofstream out(path);
+    out << s.xs.size() << "\n" << setprecision(17);
+    for (size_t i = 0; i < s.xs.size(); i++)
+    {
+        out << s.xs[i] << " " << s.ys[i] << "\n";
+    }
+}
+/**
+ * @brief Runs split() and merge() on a polygon on the general path and reads its counters.
+ *
+ * @param reps runs to take the fastest time of
+ */
+Effort measure(const Shape &s, int reps)
+{
+    int n = s.xs.size();
+    Effort e;
+    e.us_per_vertex = INFINITY;
+    for (int r = 0; r < reps; r++)
+    {
+        vector<double> xs = s.xs, ys = s.ys;
+        DCEL dcel(n);
+        dcel.verbose = false;
+        dcel.use_small_path = false;
+        dcel.split_budget_iterations = 50LL * n;
+        dcel.build(xs, ys);
+        int m = 0;
+        auto t0 = chrono::steady_clock::now();
+        dcel.split(n, m);
+        dcel.merge(n, m);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+        e = {dcel.split_iterations, dcel.split_failed, dcel.split_backtracks, min(e.us_per_vertex, us / n), dcel.budget_hit};
+    }
+    return e;
+}
+/**
+ * @brief Score of a polygon under an objective, per vertex.
+ */
+double score(const Effort &e, const string &objective, int n)
+{
+    if (objective == "failed")
+    {
+        return (double)e.failed / n;
+    }
+    if (objective == "backtracks")
+    {
+        return (double)e.backtracks / n;
+    }
+    if (objective == "time")
+    {
+        return e.us_per_vertex;
+    }
+    return (double)e.iterations / n;
+}
+/**
+ * @brief Runs the search with the options on the command line and writes the corpus.
+ *
+ * @return 0 if the program executes successfully
+ */
+int main(int argc, char **argv)
+{
+    string objective = "iterations", start = "star", dir = "corpus";
+    int n = 64, max_n = 256, keep = 8;
+    double seconds = 30;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        string arg = argv[i], val = argv[i + 1];
+        if (arg == "--objective")
+        {
+            objective = val;
+        }
+        else if (arg == "--n")
+        {
+            n = max(4, atoi(val.c_str()));
+        }
+        else if (arg == "--max-n")
+        {
+            max_n = atoi(val.c_str());
+        }
+        else if (arg == "--seconds")
+        {
+            seconds = atof(val.c_str());
+        }
+        else if (arg == "--seed")
+        {
+            seed = atoi(val.c_str());
+        }
+        else if (arg == "--start")
+        {
+            start = val;
+        }
+        else if (arg == "--keep")
+        {
+            keep = max(1, atoi(val.c_str()));
+        }
+        else if (arg == "--corpus")
+        {
+            dir = val;
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if (objective != "iterations" && objective != "failed" && objective != "backtracks" && objective != "time")
+    {
+        cerr << "Unknown objective " << objective << "\n";
+        return 1;
+    }
+    max_n = max(max_n, n);
+    filesystem::create_directories(dir);
+    string pending = dir + "/pending.txt";
+    mt19937 rng(seed);
+
+    auto fresh = [&]() {
+        Shape s;
+        do
+        {
+            s = start == "spiral" ? spiral_shape(n, rng) : star_shape(n, rng);
+        } while (!valid_shape(s));
+        return s;
+    };
+    auto evaluate = [&](const Shape &s) {
+        write_shape(s, pending);
+        Effort e = measure(s, objective == "time" ? 3 : 1);
+        filesystem::remove(pending);
+        return e;
+    };
+    // the worst polygons so far, highest score first; one per score, since a climb reaches the same score
+    // through many nearly equal polygons
+    vector<pair<double, Shape>> worst;
+    auto offer = [&](double sc, const Shape &s) {
+        for (auto &w : worst)
+        {
+            if (w.first == sc)
+            {
+                return;
+            }
+        }
+        worst.push_back({sc, s});
+        stable_sort(worst.begin(), worst.end(), [](const pair<double, Shape> &a, const pair<double, Shape> &b) {
+            return a.first > b.first;
+        });
+        if ((int)worst.size() > keep)
+        {
+            worst.pop_back();
+        }
+    };
+
+    Shape cur = fresh();
+    double best = score(evaluate(cur), objective, cur.xs.size());
+    offer(best, cur);
+    long long tries = 0, accepted = 0, restarts = 0, stall = 0;
+    auto begin = chrono::steady_clock::now();
+    while (chrono::duration<double>(chrono::steady_clock::now() - begin).count() < seconds)
+    {
+        Shape m = mutate(cur, max_n, rng);
+        tries++;
+        if (!valid_shape(m))
+        {
+            continue;
+        }
+        Effort e = evaluate(m);
+        double sc = score(e, objective, m.xs.size());
+        if (e.budget_hit)
+        {
+            cout << "split() ran out of its budget on a polygon with " << m.xs.size() << " vertices" << endl;
+        }
+        if (sc >= best)
+        {
+            stall = sc > best ? 0 : stall + 1;
+            best = sc;
+            cur = m;
+            accepted++;
+            offer(sc, m);
+        }
+        else
+        {
+            stall++;
+        }
+        if (stall > 2000)
+        {
+            cur = fresh();
+            best = score(evaluate(cur), objective, cur.xs.size());
+            offer(best, cur);
+            restarts++;
+            stall = 0;
+        }
+    }
+
+    // replace the corpus of this objective, index.txt keeps the entries of the other ones
+    for (auto &f : filesystem::directory_iterator(dir))
+    {
+        if (f.path().filename().string().rfind(objective + "-", 0) == 0)
+        {
+            filesystem::remove(f.path());
+        }
+    }
+    vector<string> lines;
+    {
+        ifstream old(dir + "/index.txt");
+        string line;
+        while (getline(old, line))
+        {
+            if (line.rfind(objective + "-", 0) != 0)
+            {
+                lines.push_back(line);
+            }
+        }
+    }
+    ofstream index(dir + "/index.txt");
+    for (auto &line : lines)
+    {
+        index << line << "\n";
+    }
+    for (size_t k = 0; k < worst.size(); k++)
+    {
+        string name = objective + "-" + to_string(k) + ".txt";
+        write_shape(worst[k].second, dir + "/" + name);
+        index << name << " " << objective << " " << worst[k].first << " " << worst[k].second.xs.size() << "\n";
+    }
+    cout << tries << " mutants, " << accepted << " accepted, " << restarts << " restarts; worst " << objective
+         << " per vertex " << (worst.empty() ? 0 : worst[0].first) << ", written to " << dir << endl;
+    return 0;
+}
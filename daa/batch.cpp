@@ -0,0 +1,257 @@
+/**
+ * @file batch.cpp
+ * @brief Decomposes every polygon of a multi-polygon file through a parse -> split/merge -> write pipeline.
+ *
+ * Build with g++ -O2 -pthread batch.cpp -o batch and run
+ *     ./batch polygons.txt pieces.txt [workers] [--serial]
+ *
+ * polygons.txt holds polygons one after the other, each in the format of input.txt (the number of vertices,
+ * then one "x y" line per vertex). For every polygon, in input order, pieces.txt gets a line "polygon i k"
+ * followed by the k convex pieces, one line of vertex ids (positions in that polygon) per piece.
+ *
+ * One thread parses, a pool of workers runs split() and merge(), one thread writes. Polygon i goes to worker
+ * i % workers, so the stages are linked by single-producer single-consumer queues only, and the writer restores
+ * the input order by reading the workers' output queues round robin. The queues are bounded: a slow stage makes
+ * the ones before it wait instead of buffering the whole file. --serial runs the three stages one after the
+ * other in one thread, for comparison.
+ */
+#include <bits/stdc++.h>
+#include <chrono>
+#include <thread>
+#include "DCEL.hpp"
+#include "SpscQueue.hpp"
+
+using namespace std;
+/**
+ * @brief Slots of every queue of the pipeline.
+ */
+const int QUEUE_CAPACITY = 64;
+/**
+ * @brief A polygon on its way through the pipeline; pieces are filled in by the workers.
+ */
+struct Job
+{
+    long long index;
+    vector<double> xs, ys;
+    vector<int> offsets, indices;
+};
+/**
+ * @brief Reads the next polygon of the file.
+ *
+ * @return true if one was read.
+ * @return false at the end of the file.
+ */
+bool parse_polygon(ifstream &in, Job &job)
+{
+    int n;
+    if (!(in >> n) || n <= 0)
+    {
+        return false;
+    }
+    job.xs.resize(n);
+    job.ys.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        in >> job.xs[i] >> job.ys[i];
+    }
+    return bool(in);
+}
+/**
+ * @brief Runs split() and merge() on a polygon and keeps its pieces as offsets into a list of vertex ids.
+ */
+void decompose_job(Job &job)
+{
+    int n = job.xs.size();
+    job.offsets.assign(1, 0);
+    job.indices.clear();
+    if (n < 3)
+    {
+        return;
+    }
+    DCEL dcel(n);
+    dcel.verbose = false;
+    dcel.build(job.xs, job.ys);
+    int m = 0;
+    dcel.split(n, m);
+    dcel.merge(n, m);
+    for (auto &f : dcel.convex_faces())
+    {
+        for (auto v : f)
+        {
+            job.indices.push_back(dcel.source_id(v));
+        }
+        job.offsets.push_back(job.indices.size());
+    }
+}
+/**
+ * @brief Appends the pieces of a polygon to the output.
+ */
+void write_job(ofstream &out, const Job &job)
+{
+    int k = job.offsets.size() - 1;
+    string s = "polygon " + to_string(job.index) + " " + to_string(k) + "\n";
+    for (int p = 0; p < k; p++)
+    {
+        for (int i = job.offsets[p]; i < job.offsets[p + 1]; i++)
+        {
+            s += to_string(job.indices[i]);
+            s += i + 1 < job.offsets[p + 1] ? ' ' : '\n';
+        }
+    }
+    out << s;
+}
+
+typedef chrono::steady_clock::time_point time_point;
+
+double elapsed_ms(time_point a, time_point b)
+{
+    return chrono::duration<double, milli>(b - a).count();
+}
+/**
+ * @brief Processes the file through the pipeline.
+ *
+ * @param busy receives the time each stage spent working, not waiting on a queue: parse, split/merge summed
+ * over the workers, write
+ * @return number of polygons
+ */
+long long run_pipeline(ifstream &in, ofstream &out, int workers, double busy[3])
+{
+    vector<unique_ptr<SpscQueue<Job>>> todo, done;
+    for (int w = 0; w < workers; w++)
+    {
+        todo.emplace_back(new SpscQueue<Job>(QUEUE_CAPACITY));
+        done.emplace_back(new SpscQueue<Job>(QUEUE_CAPACITY));
+    }
+    vector<double> worker_busy(workers, 0);
+    double parse_busy = 0, write_busy = 0;
+
+    thread parser([&] {
+        long long i = 0;
+        while (true)
+        {
+            auto t0 = chrono::steady_clock::now();
+            Job job;
+            job.index = i;
+            bool ok = parse_polygon(in, job);
+            parse_busy += elapsed_ms(t0, chrono::steady_clock::now());
+            if (!ok)
+            {
+                break;
+            }
+            todo[i % workers]->push(move(job));
+            i++;
+        }
+        for (auto &q : todo)
+        {
+            q->close();
+        }
+    });
+    vector<thread> pool;
+    for (int w = 0; w < workers; w++)
+    {
+        pool.emplace_back([&, w] {
+            Job job;
+            while (todo[w]->pop(job))
+            {
+                auto t0 = chrono::steady_clock::now();
+                decompose_job(job);
+                worker_busy[w] += elapsed_ms(t0, chrono::steady_clock::now());
+                done[w]->push(move(job));
+            }
+            done[w]->close();
+        });
+    }
+    long long written = 0;
+    Job job;
+    while (done[written % workers]->pop(job))
+    {
+        auto t0 = chrono::steady_clock::now();
+        write_job(out, job);
+        write_busy += elapsed_ms(t0, chrono::steady_clock::now());
+        written++;
+    }
+    parser.join();
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+    busy[0] = parse_busy;
+    busy[1] = accumulate(worker_busy.begin(), worker_busy.end(), 0.0);
+    busy[2] = write_busy;
+    return written;
+}
+/**
+ * @brief Processes the file one polygon at a time, each stage after the other.
+ */
+long long run_serial(ifstream &in, ofstream &out, double busy[3])
+{
+    long long i = 0;
+    busy[0] = busy[1] = busy[2] = 0;
+    while (true)
+    {
+        Job job;
+        job.index = i;
+        auto t0 = chrono::steady_clock::now();
+        if (!parse_polygon(in, job))
+        {
+            break;
+        }
+        auto t1 = chrono::steady_clock::now();
+        decompose_job(job);
+        auto t2 = chrono::steady_clock::now();
+        write_job(out, job);
+        auto t3 = chrono::steady_clock::now();
+        busy[0] += elapsed_ms(t0, t1);
+        busy[1] += elapsed_ms(t1, t2);
+        busy[2] += elapsed_ms(t2, t3);
+        i++;
+    }
+    return i;
+}
+/**
+ * @brief Runs the pipeline on the files named on the command line and reports the time of every stage.
+ *
+ * @return 0 if the program executes successfully
+ */
+int main(int argc, char **argv)
+{
+    vector<string> args;
+    bool serial = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--serial")
+        {
+            serial = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() < 2)
+    {
+        cerr << "Usage: " << argv[0] << " polygons.txt pieces.txt [workers] [--serial]\n";
+        return 1;
+    }
+    int workers = args.size() > 2 ? atoi(args[2].c_str()) : max(1u, thread::hardware_concurrency());
+    workers = max(1, workers);
+    ifstream in(args[0]);
+    ofstream out(args[1]);
+    if (!in || !out)
+    {
+        cerr << "Cannot open " << (!in ? args[0] : args[1]) << "\n";
+        return 1;
+    }
+    double busy[3];
+    auto t0 = chrono::steady_clock::now();
+    long long count = serial ? run_serial(in, out, busy) : run_pipeline(in, out, workers, busy);
+    out.flush();
+    double wall = elapsed_ms(t0, chrono::steady_clock::now());
+    cout << count << " polygons in " << wall << " ms";
+    if (!serial)
+    {
+        cout << " with " << workers << " workers";
+    }
+    cout << "\nparse " << busy[0] << " ms, split+merge " << busy[1] << " ms, write " << busy[2] << " ms" << endl;
+    return 0;
+}
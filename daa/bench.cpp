@@ -0,0 +1,693 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmark runner for the split and merge algorithms.
+ *
+ * Build with g++ -O2 -march=native -pthread bench.cpp -o bench and run ./bench [suite]; the suites are listed
+ * in main() and all of them but scaling run when no suite is given. ./bench scaling [file.json] writes the
+ * per-phase times that complexity.py fits, and ./bench merge file.snap times merge() alone on a snapshot written
+ * by main --save-split. ./bench corpus DIR replays the polygons adversary.cpp saved in DIR. ./bench counters
+ * reads the hardware counters of every phase (see PerfCounters.hpp), and ./bench lod compares decompose_levels()
+ * with decomposing every level on its own. Polygons are random
+ * clockwise star shaped polygons, generated like gen.py does.
+ *
+ * The memory suite needs -DMEMORY_STATS, which replaces operator new with the counting one of MemoryStats.hpp;
+ * it is off by default because the counting slows the allocation heavy suites down by up to a third.
+ */
+#include <bits/stdc++.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include "DCEL.hpp"
+#include "PointLocation.hpp"
+#include "HalfPlanes.hpp"
+#include "Snapshot.hpp"
+#include "PerfCounters.hpp"
+#include "LevelOfDetail.hpp"
+#ifdef MEMORY_STATS
+#include "MemoryStats.hpp"
+#endif
+
+using namespace std;
+/**
+ * @brief Generates a random clockwise star shaped polygon with n vertices.
+ *
+ * @param n number of vertices
+ * @param rng random number generator
+ * @return the vertex coordinates
+ */
+vector<pair<double, double>> random_polygon(int n, mt19937 &rng)
+{
+    uniform_real_distribution<double> jitter(0.1, 0.9), radius(100, 250);
+    vector<pair<double, double>> pts;
+    for (int i = 0; i < n; i++)
+    {
+        double ang = 2 * M_PI * (n - i - jitter(rng)) / n;
+        double r = radius(rng);
+        pts.push_back({r * cos(ang), r * sin(ang)});
+    }
+    return pts;
+}
+/**
+ * @brief Builds a DCEL for the polygon and runs split and merge on it.
+ *
+ * @param pts vertex coordinates
+ * @param small whether DCEL may use the small polygon path
+ * @return the merged DCEL
+ */
+DCEL *build_merged(const vector<pair<double, double>> &pts, bool small)
+{
+    int n = pts.size();
+    DCEL *root = new DCEL(n);
+    for (int i = 0; i < n; i++)
+    {
+        root->vertices[i] = new Vertex(i, pts[i].first, pts[i].second, NULL);
+    }
+    root->link_edges();
+    root->use_small_path = root->use_small_path and small;
+    root->verbose = false;
+    int m = 0;
+    root->split(n, m);
+    root->merge(n, m);
+    return root;
+}
+/**
+ * @brief Decomposes the polygon through DCEL.
+ *
+ * @param pts vertex coordinates
+ * @param small whether DCEL may use the small polygon path
+ * @return number of edges left after merging
+ */
+int decompose(const vector<pair<double, double>> &pts, bool small)
+{
+    DCEL *root = build_merged(pts, small);
+    int cnt = 0;
+    for (auto e : root->edges)
+    {
+        cnt += e->isrequired;
+    }
+    delete root;
+    return cnt;
+}
+/**
+ * @brief Runs split and merge on SmallPolygon alone, without building a DCEL.
+ *
+ * @param pts vertex coordinates
+ * @return number of edges left after merging
+ */
+int decompose_small(const vector<pair<double, double>> &pts)
+{
+    int n = pts.size();
+    double xs[SMALL_POLYGON_LIMIT], ys[SMALL_POLYGON_LIMIT];
+    for (int i = 0; i < n; i++)
+    {
+        xs[i] = pts[i].first;
+        ys[i] = pts[i].second;
+    }
+    SmallPolygon<SMALL_POLYGON_LIMIT> sp;
+    sp.load(xs, ys, n);
+    sp.split();
+    sp.merge();
+    int cnt = n;
+    for (int j = 0; j < sp.m; j++)
+    {
+        cnt += !sp.removed[j];
+    }
+    return cnt;
+}
+/**
+ * @brief Times f over all the polygons, repeated until at least a fixed amount of time has passed.
+ *
+ * @return polygons per second
+ */
+template <class F>
+double throughput(const vector<vector<pair<double, double>>> &polys, F f)
+{
+    long long done = 0, check = 0;
+    auto start = chrono::high_resolution_clock::now();
+    double elapsed = 0;
+    while (elapsed < 0.2)
+    {
+        for (auto &p : polys)
+        {
+            check += f(p);
+        }
+        done += polys.size();
+        elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    }
+    if (check < 0)
+    {
+        cerr << check;
+    }
+    return done / elapsed;
+}
+/**
+ * @brief Prints polygons/s of the general path, the small polygon path through DCEL and SmallPolygon alone
+ * for n = 4..SMALL_POLYGON_LIMIT.
+ */
+void bench_small()
+{
+    mt19937 rng(2023);
+    cout << "n general small_dcel small_only (polygons/s)\n";
+    for (int n = 4; n <= SMALL_POLYGON_LIMIT; n++)
+    {
+        vector<vector<pair<double, double>>> polys;
+        for (int i = 0; i < 256; i++)
+        {
+            polys.push_back(random_polygon(n, rng));
+        }
+        double general = throughput(polys, [](const vector<pair<double, double>> &p) { return decompose(p, false); });
+        double small = throughput(polys, [](const vector<pair<double, double>> &p) { return decompose(p, true); });
+        double bare = throughput(polys, decompose_small);
+        cout << n << " " << general << " " << small << " " << bare << "\n";
+    }
+}
+/**
+ * @brief Prints point location queries/s over the merged pieces of polygons of growing size, with one thread
+ * and with every hardware thread, next to a scan over all the pieces.
+ */
+void bench_locate()
+{
+    mt19937 rng(2023);
+    int threads = max(1u, thread::hardware_concurrency());
+    cout << "n pieces locate_1 locate_" << threads << " scan (queries/s)\n";
+    for (int n : {100, 500, 2000})
+    {
+        auto pts = random_polygon(n, rng);
+        DCEL *root = build_merged(pts, true);
+        PointLocator loc(root);
+        delete root;
+        const size_t q = 1 << 20;
+        uniform_real_distribution<double> coord(-250, 250);
+        vector<double> xs(q), ys(q);
+        vector<int> res(q);
+        for (size_t i = 0; i < q; i++)
+        {
+            xs[i] = coord(rng);
+            ys[i] = coord(rng);
+        }
+        auto t0 = chrono::high_resolution_clock::now();
+        loc.locate(xs.data(), ys.data(), res.data(), q, 1);
+        auto t1 = chrono::high_resolution_clock::now();
+        loc.locate(xs.data(), ys.data(), res.data(), q, threads);
+        auto t2 = chrono::high_resolution_clock::now();
+        // what a consumer without the index does: test every piece in turn
+        size_t sq = q / 64;
+        long long hits = 0;
+        for (size_t i = 0; i < sq; i++)
+        {
+            for (auto &p : loc.pieces)
+            {
+                bool left = true, right = true;
+                int m = p.size();
+                for (int j = 0; j < m && (left || right); j++)
+                {
+                    auto &a = pts[p[j]], &b = pts[p[(j + 1) % m]];
+                    double c = (b.first - a.first) * (ys[i] - a.second) - (b.second - a.second) * (xs[i] - a.first);
+                    left = left && c >= 0;
+                    right = right && c <= 0;
+                }
+                if (left || right)
+                {
+                    hits++;
+                    break;
+                }
+            }
+        }
+        auto t3 = chrono::high_resolution_clock::now();
+        // both have to agree on how many of the scanned points are inside
+        long long found = 0;
+        for (size_t i = 0; i < sq; i++)
+        {
+            found += res[i] >= 0;
+        }
+        if (found != hits)
+        {
+            cerr << "locate found " << found << " points inside, scan found " << hits << "\n";
+        }
+        double d1 = chrono::duration<double>(t1 - t0).count();
+        double d2 = chrono::duration<double>(t2 - t1).count();
+        double d3 = chrono::duration<double>(t3 - t2).count();
+        cout << n << " " << loc.pieces.size() << " " << q / d1 << " " << q / d2 << " " << sq / d3 << "\n";
+    }
+}
+/**
+ * @brief Prints containment tests/s of the half-plane table, SIMD kernels against their scalar versions, for
+ * many points against each piece and for one point against all the pieces.
+ */
+void bench_halfplane()
+{
+    mt19937 rng(2023);
+    cout << "n pieces kernel simd scalar (point-piece tests/s)\n";
+    for (int n : {100, 2000})
+    {
+        DCEL *root = build_merged(random_polygon(n, rng), true);
+        HalfPlaneTable table(root);
+        PointLocator loc(root);
+        delete root;
+        int k = table.pieces.size();
+        const size_t q = 4096;
+        uniform_real_distribution<double> coord(-250, 250);
+        vector<double> xs(q), ys(q);
+        for (size_t i = 0; i < q; i++)
+        {
+            xs[i] = coord(rng);
+            ys[i] = coord(rng);
+        }
+        vector<unsigned char> r1(q), r2(q), inside(q);
+        bool agree = true;
+        auto t0 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < k; p++)
+        {
+            table.contains(p, xs.data(), ys.data(), r1.data(), q);
+            for (size_t i = 0; i < q; i++)
+            {
+                inside[i] |= r1[i];
+            }
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < k; p++)
+        {
+            table.contains_scalar(p, xs.data(), ys.data(), r2.data(), q);
+            for (size_t i = 0; i < q; i++)
+            {
+                inside[i] |= r2[i] << 1;
+            }
+        }
+        auto t2 = chrono::high_resolution_clock::now();
+        vector<unsigned char> s1(k), s2(k);
+        long long hits = 0;
+        for (size_t i = 0; i < q; i++)
+        {
+            table.contains(xs[i], ys[i], s1.data());
+            hits += accumulate(s1.begin(), s1.end(), 0);
+        }
+        auto t3 = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < q; i++)
+        {
+            table.contains_scalar(xs[i], ys[i], s2.data());
+            hits -= accumulate(s2.begin(), s2.end(), 0);
+        }
+        auto t4 = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < q; i++)
+        {
+            agree = agree && (inside[i] == 0 || inside[i] == 3) && (inside[i] == 3) == (loc.locate(xs[i], ys[i]) >= 0);
+        }
+        if (!agree || hits != 0)
+        {
+            cerr << "half-plane kernels disagree\n";
+        }
+        double tests = (double)q * k;
+        cout << n << " " << k << " points_vs_piece " << tests / chrono::duration<double>(t1 - t0).count() << " " << tests / chrono::duration<double>(t2 - t1).count() << "\n";
+        cout << n << " " << k << " point_vs_pieces " << tests / chrono::duration<double>(t3 - t2).count() << " " << tests / chrono::duration<double>(t4 - t3).count() << "\n";
+    }
+}
+/**
+ * @brief Writes the time of every phase (split, merge and its lpv and merge_loop parts, output) for polygons of
+ * growing size as JSON, the input of complexity.py. Each time is the median of a few runs; with -DMEMORY_STATS the entries of the
+ * split, merge and output phases also carry their allocated bytes and peak live heap.
+ *
+ * @param path file to write, "-" for cout
+ */
+void bench_scaling(const string &path)
+{
+    mt19937 rng(2023);
+    const int reps = 3;
+    vector<string> entries;
+    for (int n : {100, 200, 400, 800, 1600, 3200})
+    {
+        auto pts = random_polygon(n, rng);
+        map<string, vector<double>> ms;
+        map<string, pair<long long, long long>> mem;
+        for (int r = 0; r < reps; r++)
+        {
+            DCEL *root = new DCEL(n);
+            for (int i = 0; i < n; i++)
+            {
+                root->vertices[i] = new Vertex(i, pts[i].first, pts[i].second, NULL);
+            }
+            root->link_edges();
+            root->use_small_path = false;
+            root->verbose = false;
+            int m = 0;
+#ifdef MEMORY_STATS
+            MemoryStats::reset();
+            MemoryStats::phase("split");
+#endif
+            auto t0 = chrono::steady_clock::now();
+            root->split(n, m);
+            auto t1 = chrono::steady_clock::now();
+#ifdef MEMORY_STATS
+            MemoryStats::phase("merge");
+#endif
+            root->merge(n, m);
+#ifdef MEMORY_STATS
+            MemoryStats::phase("output");
+#endif
+            auto t2 = chrono::steady_clock::now();
+            auto pieces = root->convex_faces();
+            auto t3 = chrono::steady_clock::now();
+#ifdef MEMORY_STATS
+            MemoryStats::finish();
+            for (auto &p : MemoryStats::phases())
+            {
+                mem[p.name] = {p.bytes, p.peak_live};
+            }
+#endif
+            ms["split"].push_back(chrono::duration<double, milli>(t1 - t0).count());
+            ms["merge"].push_back(chrono::duration<double, milli>(t2 - t1).count());
+            ms["lpv"].push_back(root->lpv_ms);
+            ms["merge_loop"].push_back(root->merge_loop_ms);
+            ms["output"].push_back(chrono::duration<double, milli>(t3 - t2).count());
+            delete root;
+        }
+        for (auto &[phase, v] : ms)
+        {
+            sort(v.begin(), v.end());
+            ostringstream e;
+            e << "{\"n\": " << n << ", \"phase\": \"" << phase << "\", \"ms\": " << v[v.size() / 2];
+            if (mem.count(phase))
+            {
+                e << ", \"bytes\": " << mem[phase].first << ", \"peak_heap\": " << mem[phase].second;
+            }
+            e << "}";
+            entries.push_back(e.str());
+        }
+    }
+    ofstream file;
+    if (path != "-")
+    {
+        file.open(path);
+    }
+    ostream &out = path != "-" ? file : cout;
+    out << "{\"runs\": [\n";
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        out << "  " << entries[i] << (i + 1 < entries.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+/**
+ * @brief Times merge() alone on a DCEL loaded from a snapshot, reloading it before every run.
+ *
+ * @param path snapshot written by save_snapshot()
+ */
+void bench_merge(const string &path)
+{
+    const int reps = 9;
+    vector<double> load_ms, merge_ms;
+    int n = 0;
+    for (int r = 0; r < reps; r++)
+    {
+        int m = 0;
+        auto t0 = chrono::steady_clock::now();
+        DCEL *root = load_snapshot(path, m);
+        auto t1 = chrono::steady_clock::now();
+        if (!root)
+        {
+            cerr << "Cannot read the snapshot " << path << "\n";
+            return;
+        }
+        root->verbose = false;
+        n = root->vertices.size();
+        root->merge(n, m);
+        auto t2 = chrono::steady_clock::now();
+        load_ms.push_back(chrono::duration<double, milli>(t1 - t0).count());
+        merge_ms.push_back(chrono::duration<double, milli>(t2 - t1).count());
+        delete root;
+    }
+    sort(load_ms.begin(), load_ms.end());
+    sort(merge_ms.begin(), merge_ms.end());
+    cout << "n load_ms merge_ms (median of " << reps << ")\n";
+    cout << n << " " << load_ms[reps / 2] << " " << merge_ms[reps / 2] << "\n";
+}
+/**
+ * @brief Replays a corpus of polygons in the format of input.txt, such as the worst cases adversary.cpp finds:
+ * prints the split() counters of each and the median time of split() and merge() per vertex, so a change that
+ * makes one of them slower shows up.
+ *
+ * @param dir directory of the corpus; every *.txt but index.txt is a polygon
+ */
+void bench_corpus(const string &dir)
+{
+    vector<string> files;
+    for (auto &f : filesystem::directory_iterator(dir))
+    {
+        string name = f.path().filename().string();
+        if (f.path().extension() == ".txt" && name != "index.txt" && name != "pending.txt")
+        {
+            files.push_back(f.path().string());
+        }
+    }
+    sort(files.begin(), files.end());
+    const int reps = 5;
+    cout << "file n iterations failed backtracks split_ms merge_ms us_per_vertex\n";
+    for (auto &path : files)
+    {
+        ifstream in(path);
+        int n = 0;
+        in >> n;
+        vector<double> xs(n), ys(n);
+        for (int i = 0; i < n; i++)
+        {
+            in >> xs[i] >> ys[i];
+        }
+        if (!in || n < 3)
+        {
+            cerr << "Cannot read " << path << "\n";
+            continue;
+        }
+        vector<double> split_ms, merge_ms;
+        long long iterations = 0, failed = 0, backtracks = 0;
+        for (int r = 0; r < reps; r++)
+        {
+            vector<double> x = xs, y = ys;
+            DCEL dcel(n);
+            dcel.verbose = false;
+            dcel.use_small_path = false;
+            dcel.split_budget_iterations = 50LL * n;
+            dcel.build(x, y);
+            int m = 0;
+            auto t0 = chrono::steady_clock::now();
+            dcel.split(n, m);
+            auto t1 = chrono::steady_clock::now();
+            dcel.merge(n, m);
+            auto t2 = chrono::steady_clock::now();
+            split_ms.push_back(chrono::duration<double, milli>(t1 - t0).count());
+            merge_ms.push_back(chrono::duration<double, milli>(t2 - t1).count());
+            iterations = dcel.split_iterations;
+            failed = dcel.split_failed;
+            backtracks = dcel.split_backtracks;
+        }
+        sort(split_ms.begin(), split_ms.end());
+        sort(merge_ms.begin(), merge_ms.end());
+        double s = split_ms[reps / 2], m = merge_ms[reps / 2];
+        cout << filesystem::path(path).filename().string() << " " << n << " " << iterations << " " << failed << " "
+             << backtracks << " " << s << " " << m << " " << (s + m) * 1000 / n << "\n";
+    }
+}
+/**
+ * @brief Prints the hardware counters of the build, split, merge and output phases for polygons of growing
+ * size: cycles, instructions and IPC, then the L1 data, last level cache, branch and dTLB misses per vertex.
+ * Each value is the median of a few runs. Counters the kernel does not give read as "-", and when there are
+ * none at all only the times are printed.
+ */
+void bench_counters()
+{
+    PerfCounters perf;
+    if (!perf.available())
+    {
+        cerr << "No hardware counters: " << perf.why_unavailable() << ", printing times only\n";
+    }
+    else if (!perf.why_unavailable().empty())
+    {
+        cerr << "Some hardware counters are missing: " << perf.why_unavailable() << "\n";
+    }
+    mt19937 rng(2023);
+    const int reps = 5;
+    const char *phases[] = {"build", "split", "merge", "output"};
+    cout << "n phase ms cycles instructions ipc l1d_per_vertex llc_per_vertex branch_misses_per_vertex "
+            "dtlb_per_vertex\n";
+    for (int n : {1000, 2000, 4000, 8000})
+    {
+        auto pts = random_polygon(n, rng);
+        vector<double> ms[4];
+        vector<long long> counts[4][PERF_EVENTS];
+        for (int r = 0; r < reps; r++)
+        {
+            PerfCounters::Reading reading[4];
+            chrono::steady_clock::time_point t[5];
+            int m = 0;
+            t[0] = chrono::steady_clock::now();
+            perf.start();
+            DCEL *root = new DCEL(n);
+            for (int i = 0; i < n; i++)
+            {
+                root->vertices[i] = new Vertex(i, pts[i].first, pts[i].second, NULL);
+            }
+            root->link_edges();
+            root->use_small_path = false;
+            root->verbose = false;
+            reading[0] = perf.stop();
+            t[1] = chrono::steady_clock::now();
+            perf.start();
+            root->split(n, m);
+            reading[1] = perf.stop();
+            t[2] = chrono::steady_clock::now();
+            perf.start();
+            root->merge(n, m);
+            reading[2] = perf.stop();
+            t[3] = chrono::steady_clock::now();
+            perf.start();
+            auto pieces = root->convex_faces();
+            reading[3] = perf.stop();
+            t[4] = chrono::steady_clock::now();
+            for (int p = 0; p < 4; p++)
+            {
+                ms[p].push_back(chrono::duration<double, milli>(t[p + 1] - t[p]).count());
+                for (int e = 0; e < PERF_EVENTS; e++)
+                {
+                    counts[p][e].push_back(reading[p].value[e]);
+                }
+            }
+            delete root;
+        }
+        for (int p = 0; p < 4; p++)
+        {
+            PerfCounters::Reading median;
+            for (int e = 0; e < PERF_EVENTS; e++)
+            {
+                sort(counts[p][e].begin(), counts[p][e].end());
+                median.value[e] = counts[p][e][reps / 2];
+            }
+            sort(ms[p].begin(), ms[p].end());
+            auto field = [](double v) {
+                ostringstream f;
+                f << v;
+                return v < 0 ? string("-") : f.str();
+            };
+            auto count = [](long long v) { return v < 0 ? string("-") : to_string(v); };
+            cout << n << " " << phases[p] << " " << ms[p][reps / 2] << " " << count(median.value[PERF_CYCLES]) << " "
+                 << count(median.value[PERF_INSTRUCTIONS]) << " " << field(median.ipc()) << " "
+                 << field(median.per(PERF_L1D_MISSES, n)) << " " << field(median.per(PERF_LLC_MISSES, n)) << " "
+                 << field(median.per(PERF_BRANCH_MISSES, n)) << " " << field(median.per(PERF_DTLB_MISSES, n)) << "\n";
+        }
+    }
+}
+/**
+ * @brief Prints the time and the pieces of decompose_levels() against decomposing the outline of every level on
+ * its own, for polygons of growing size whose outline has detail at several scales.
+ */
+void bench_lod()
+{
+    mt19937 rng(2023);
+    normal_distribution<double> noise(0, 1);
+    const vector<double> tolerances = {0, 0.05, 0.2, 1, 4};
+    cout << "n levels lod_ms independent_ms lod_pieces independent_pieces\n";
+    for (int n : {2000, 8000, 32000})
+    {
+        vector<double> xs(n), ys(n);
+        for (int i = 0; i < n; i++)
+        {
+            double t = 2 * M_PI * (n - i) / n;
+            double r = 200 + 30 * sin(7 * t) + 8 * sin(31 * t) + 2 * sin(97 * t) + 0.05 * noise(rng);
+            xs[i] = r * cos(t);
+            ys[i] = r * sin(t);
+        }
+        auto t0 = chrono::steady_clock::now();
+        vector<LodLevel> levels = decompose_levels(xs, ys, tolerances);
+        auto t1 = chrono::steady_clock::now();
+        size_t lod_pieces_total = 0, independent = 0;
+        for (auto &level : levels)
+        {
+            lod_pieces_total += level.pieces.size();
+            independent += lod_pieces(xs, ys, level.ids).size();
+        }
+        auto t2 = chrono::steady_clock::now();
+        cout << n << " " << levels.size() << " " << chrono::duration<double, milli>(t1 - t0).count() << " "
+             << chrono::duration<double, milli>(t2 - t1).count() << " " << lod_pieces_total << " " << independent
+             << "\n";
+    }
+}
+#ifdef MEMORY_STATS
+/**
+ * @brief Prints the allocations and the highest live heap of the build, split and merge phases for polygons of
+ * growing size, to fit memory use against n.
+ */
+void bench_memory()
+{
+    mt19937 rng(2023);
+    cout << "n phase allocations bytes peak_heap peak_rss_kb\n";
+    for (int n : {100, 300, 1000, 3000})
+    {
+        auto pts = random_polygon(n, rng);
+        MemoryStats::reset();
+        MemoryStats::phase("build");
+        DCEL *root = new DCEL(n);
+        for (int i = 0; i < n; i++)
+        {
+            root->vertices[i] = new Vertex(i, pts[i].first, pts[i].second, NULL);
+        }
+        root->link_edges();
+        root->verbose = false;
+        int m = 0;
+        MemoryStats::phase("split");
+        root->split(n, m);
+        MemoryStats::phase("merge");
+        root->merge(n, m);
+        MemoryStats::finish();
+        for (auto &p : MemoryStats::phases())
+        {
+            cout << n << " " << p.name << " " << p.allocs << " " << p.bytes << " " << p.peak_live << " " << p.peak_rss_kb << "\n";
+        }
+        delete root;
+    }
+}
+#endif
+/**
+ * @brief Runs the benchmark suite named on the command line, or every suite.
+ *
+ * @return 0 if the program executes successfully
+ */
+int main(int argc, char **argv)
+{
+    string suite = argc > 1 ? argv[1] : "";
+    if (suite == "" || suite == "small")
+    {
+        bench_small();
+    }
+    if (suite == "" || suite == "locate")
+    {
+        bench_locate();
+    }
+    if (suite == "" || suite == "halfplane")
+    {
+        bench_halfplane();
+    }
+    if (suite == "scaling")
+    {
+        bench_scaling(argc > 2 ? argv[2] : "-");
+    }
+    if (suite == "merge" && argc > 2)
+    {
+        bench_merge(argv[2]);
+    }
+    if (suite == "corpus" && argc > 2)
+    {
+        bench_corpus(argv[2]);
+    }
+    if (suite == "counters")
+    {
+        bench_counters();
+    }
+    if (suite == "lod")
+    {
+        bench_lod();
+    }
+#ifdef MEMORY_STATS
+    if (suite == "" || suite == "memory")
+    {
+        bench_memory();
+    }
+#endif
+    return 0;
+}
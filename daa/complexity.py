@@ -0,0 +1,91 @@
+# Fits the time (and memory) of every phase against n from the JSON written by ./bench scaling, and compares
+# it with a stored baseline.
+#
+#   python3 complexity.py results.json [more.json ...] [--baseline base.json] [--threshold 0.25]
+#
+# For every phase and metric it prints the exponent k of the least squares fit of log(value) = log(c) + k log(n)
+# and which of n, n log n, n^2 and n^3 fits best. With --baseline, a phase is flagged when it is slower than the
+# baseline by more than the threshold at some n, or when its exponent grew by more than 0.5 (a linear phase
+# turning quadratic). The exit status is 1 when something was flagged.
+import argparse
+import json
+import math
+import sys
+
+MODELS = {
+    'n': lambda n: n,
+    'n log n': lambda n: n * math.log(n),
+    'n^2': lambda n: n ** 2,
+    'n^3': lambda n: n ** 3,
+}
+METRICS = ['ms', 'bytes', 'peak_heap']
+
+
+def load(paths):
+    # (phase, metric) -> {n: [values]}
+    data = {}
+    for path in paths:
+        with open(path) as f:
+            for run in json.load(f)['runs']:
+                for metric in METRICS:
+                    if metric in run and run[metric] > 0:
+                        data.setdefault((run['phase'], metric), {}).setdefault(run['n'], []).append(run[metric])
+    # median of the repeated measurements of every size
+    return {key: {n: sorted(v)[len(v) // 2] for n, v in by_n.items()} for key, by_n in data.items()}
+
+
+def exponent(points):
+    xs = [math.log(n) for n in points]
+    ys = [math.log(v) for v in points.values()]
+    mx, my = sum(xs) / len(xs), sum(ys) / len(ys)
+    sxx = sum((x - mx) ** 2 for x in xs)
+    if sxx == 0:
+        return float('nan')
+    return sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / sxx
+
+
+def best_model(points):
+    # value ~ c * f(n); c is fitted on the log scale, so every size weighs the same
+    best = None
+    for name, f in MODELS.items():
+        logc = sum(math.log(v / f(n)) for n, v in points.items()) / len(points)
+        err = sum((math.log(v / f(n)) - logc) ** 2 for n, v in points.items())
+        if best is None or err < best[1]:
+            best = (name, err)
+    return best[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Complexity fitting of ./bench scaling results')
+    parser.add_argument('results', nargs='+')
+    parser.add_argument('--baseline')
+    parser.add_argument('--threshold', type=float, default=0.25, help='allowed relative slowdown')
+    args = parser.parse_args()
+
+    data = load(args.results)
+    base = load([args.baseline]) if args.baseline else {}
+    flagged = []
+    print('%-12s %-10s %6s %9s  %s' % ('phase', 'metric', 'sizes', 'exponent', 'best fit'))
+    for (phase, metric), points in sorted(data.items()):
+        if len(points) < 2:
+            continue
+        k = exponent(points)
+        line = '%-12s %-10s %6d %9.2f  %s' % (phase, metric, len(points), k, best_model(points))
+        old = base.get((phase, metric))
+        if old and len(old) >= 2:
+            k0 = exponent(old)
+            line += '  (baseline %.2f)' % k0
+            if k - k0 > 0.5:
+                flagged.append('%s %s: exponent %.2f, baseline %.2f' % (phase, metric, k, k0))
+            for n in sorted(points):
+                if n in old and points[n] > old[n] * (1 + args.threshold):
+                    flagged.append('%s %s: n = %d takes %.4g, baseline %.4g (+%.0f%%)' %
+                                   (phase, metric, n, points[n], old[n], 100 * (points[n] / old[n] - 1)))
+        print(line)
+    for f in flagged:
+        print('REGRESSION ' + f)
+    sys.exit(1 if flagged else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,620 @@
+/**
+ * @file daemon.cpp
+ * @brief Long running decomposition service on a Unix domain socket, and a client to talk to it.
+ *
+ * Build libdcel.so first (see dcel.h), then
+ *     g++ -O2 -pthread daemon.cpp -o dceld -L. -ldcel -Wl,-rpath,'$ORIGIN'
+ *
+ *     ./dceld serve SOCKET [threads] [options] serves until a shutdown request
+ *     ./dceld client SOCKET [file] [count]    sends the polygon of file (input.txt format, default input.txt)
+ *     ./dceld stats SOCKET                    prints the counters of the server
+ *     ./dceld shutdown SOCKET                 stops the server
+ *
+ * Options of serve:
+ *     --budget-ms MS, --budget-iterations N   bound split() on every request, see dcel_set_budget(); the pieces
+ *                                             of a request that runs out of its budget are still sent
+ *     --timeout-ms MS                         time a request may take to arrive, and a reply to be sent, before
+ *                                             the connection is closed (default 5000)
+ *
+ * Protocol, all numbers in native byte order. A connection may carry any number of requests, one after the other.
+ *     request     uint32 type
+ *       DECOMPOSE uint32 n, double x[n], double y[n]
+ *                 reply int32 k (-1 on failure), then k >= 0: uint32 total, int32 offsets[k + 1], int32 indices[total]
+ *                                                     k < 0:  uint32 length, char message[length]
+ *       STATS     reply uint32 length, char json[length]
+ *       SHUTDOWN  reply int32 0
+ * The pieces are given as in dcel_piece_offsets() and dcel_piece_indices().
+ */
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "dcel.h"
+
+using namespace std;
+
+enum RequestType : uint32_t
+{
+    DECOMPOSE = 1,
+    STATS = 2,
+    SHUTDOWN = 3
+};
+/**
+ * @brief Largest polygon a request may carry.
+ */
+const uint32_t MAX_VERTICES = 1 << 24;
+typedef chrono::steady_clock::time_point deadline_t;
+/**
+ * @brief Reads exactly len bytes from a socket.
+ *
+ * @param deadline when to give up waiting for the bytes; the default waits as long as it takes
+ * @return true if they were read.
+ * @return false on error, end of stream or when the deadline passed.
+ */
+bool read_all(int fd, void *buf, size_t len, deadline_t deadline = deadline_t::max())
+{
+    char *p = (char *)buf;
+    while (len)
+    {
+        if (deadline != deadline_t::max())
+        {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+            pollfd pfd = {fd, POLLIN, 0};
+            int ready = left > 0 ? poll(&pfd, 1, left) : 0;
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ready <= 0)
+            {
+                return false;
+            }
+        }
+        ssize_t r = recv(fd, p, len, 0);
+        if (r < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (r <= 0)
+        {
+            return false;
+        }
+        p += r;
+        len -= r;
+    }
+    return true;
+}
+/**
+ * @brief Writes exactly len bytes to a socket.
+ *
+ * @return true if they were written.
+ * @return false otherwise, e.g. when the peer went away.
+ */
+bool write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len)
+    {
+        ssize_t r = send(fd, p, len, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (r <= 0)
+        {
+            return false;
+        }
+        p += r;
+        len -= r;
+    }
+    return true;
+}
+/**
+ * @brief Opens a connection to the socket at path, -1 on failure.
+ */
+int connect_to(const string &path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof addr.sun_path - 1);
+    if (fd < 0 || connect(fd, (sockaddr *)&addr, sizeof addr) < 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+/**
+ * @brief Histogram of latencies with four buckets per power of two microseconds, safe to fill from many threads.
+ * @class LatencyHistogram
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int BUCKETS = 160;
+
+    void add(double us)
+    {
+        int b = min(BUCKETS - 1, max(0, (int)(4 * log2(us + 1))));
+        this->buckets[b].fetch_add(1, memory_order_relaxed);
+    }
+    /**
+     * @brief Upper bound of the bucket holding the p-th quantile, in microseconds; 0 when empty.
+     *
+     * @param p the quantile, in [0, 1]
+     */
+    double percentile(double p) const
+    {
+        long long total = 0;
+        for (auto &b : this->buckets)
+        {
+            total += b.load(memory_order_relaxed);
+        }
+        if (!total)
+        {
+            return 0;
+        }
+        long long rank = max(1LL, (long long)ceil(p * total)), seen = 0;
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            seen += this->buckets[b].load(memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return exp2((b + 1) / 4.0) - 1;
+            }
+        }
+        return exp2(BUCKETS / 4.0) - 1;
+    }
+
+private:
+    atomic<long long> buckets[BUCKETS] = {};
+};
+/**
+ * @brief The daemon: one thread polls the listening socket and the idle connections, a pool of workers serves
+ * the requests.
+ * @class Server
+ *
+ * A connection with data to read is taken out of the poll set and queued; the worker that picks it up reads one
+ * request, replies, and hands the connection back to the polling thread through a pipe. Each worker owns a
+ * dcel_context, warmed up with a first decomposition, whose output buffers are reused by all the requests it
+ * serves, together with its request buffers. This is buffer reuse, not an arena: the vertices, half-edges and
+ * faces of every decomposition are still allocated and freed one by one inside libdcel.
+ *
+ * A request has timeout_ms to arrive in full once its first bytes are there, so a client that stalls in the
+ * middle of one cannot hold a worker; writes time out the same way (SO_SNDTIMEO).
+ */
+class Server
+{
+public:
+    Server(const string &path, int threads);
+    int run();
+
+    double budget_ms;
+    long long budget_iterations;
+    int timeout_ms;
+
+private:
+    typedef chrono::steady_clock clock;
+    string path;
+    int threads;
+    int listen_fd;
+    int wake[2];
+    mutex mu;
+    condition_variable cv;
+    deque<pair<int, clock::time_point>> jobs;
+    vector<int> returned; // connections handed back by the workers, guarded by mu
+    atomic<bool> stopping;
+    atomic<int> queue_depth, max_queue_depth;
+    atomic<long long> requests, failures, budget_hits;
+    LatencyHistogram latency;
+
+    void worker();
+    bool serve(int fd, dcel_context *ctx, clock::time_point queued);
+    string stats();
+};
+/**
+ * @brief Prepares a server; nothing is opened before run().
+ *
+ * @param path path of the socket
+ * @param threads number of workers
+ */
+Server::Server(const string &path, int threads)
+{
+    this->path = path;
+    this->threads = max(1, threads);
+    this->listen_fd = -1;
+    this->stopping = false;
+    this->queue_depth = this->max_queue_depth = 0;
+    this->requests = this->failures = this->budget_hits = 0;
+    this->budget_ms = 0;
+    this->budget_iterations = 0;
+    this->timeout_ms = 5000;
+}
+/**
+ * @brief Listens on the socket and serves until a shutdown request.
+ *
+ * @return 0 after a shutdown, 1 if the socket could not be opened
+ */
+int Server::run()
+{
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, this->path.c_str(), sizeof addr.sun_path - 1);
+    unlink(this->path.c_str());
+    this->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (this->listen_fd < 0 || bind(this->listen_fd, (sockaddr *)&addr, sizeof addr) < 0 ||
+        listen(this->listen_fd, 128) < 0 || pipe2(this->wake, O_NONBLOCK) < 0)
+    {
+        perror("dceld");
+        return 1;
+    }
+    vector<thread> pool;
+    for (int t = 0; t < this->threads; t++)
+    {
+        pool.emplace_back(&Server::worker, this);
+    }
+    cout << "Listening on " << this->path << " with " << this->threads << " workers" << endl;
+
+    vector<int> idle;
+    while (!this->stopping)
+    {
+        vector<pollfd> fds = {{this->listen_fd, POLLIN, 0}, {this->wake[0], POLLIN, 0}};
+        for (int fd : idle)
+        {
+            fds.push_back({fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents)
+        {
+            char buf[64];
+            while (read(this->wake[0], buf, sizeof buf) > 0)
+            {
+            }
+            lock_guard<mutex> lock(this->mu);
+            idle.insert(idle.end(), this->returned.begin(), this->returned.end());
+            this->returned.clear();
+        }
+        vector<int> ready;
+        int keep = 0;
+        for (size_t i = 2; i < fds.size(); i++)
+        {
+            if (fds[i].revents)
+            {
+                ready.push_back(fds[i].fd);
+            }
+            else
+            {
+                idle[keep++] = fds[i].fd;
+            }
+        }
+        // connections returned during this round are behind the polled ones
+        idle.erase(idle.begin() + keep, idle.begin() + fds.size() - 2);
+        if (fds[0].revents)
+        {
+            int fd = accept(this->listen_fd, NULL, NULL);
+            if (fd >= 0)
+            {
+                timeval tv = {this->timeout_ms / 1000, this->timeout_ms % 1000 * 1000};
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+                idle.push_back(fd);
+            }
+        }
+        if (ready.size())
+        {
+            lock_guard<mutex> lock(this->mu);
+            for (int fd : ready)
+            {
+                this->jobs.push_back({fd, clock::now()});
+            }
+            int depth = this->queue_depth += ready.size();
+            int old = this->max_queue_depth;
+            while (depth > old && !this->max_queue_depth.compare_exchange_weak(old, depth))
+            {
+            }
+            this->cv.notify_all();
+        }
+    }
+    {
+        lock_guard<mutex> lock(this->mu);
+        this->cv.notify_all();
+    }
+    for (auto &th : pool)
+    {
+        th.join();
+    }
+    for (int fd : idle)
+    {
+        close(fd);
+    }
+    for (auto &job : this->jobs)
+    {
+        close(job.first);
+    }
+    for (int fd : this->returned)
+    {
+        close(fd);
+    }
+    close(this->listen_fd);
+    close(this->wake[0]);
+    close(this->wake[1]);
+    unlink(this->path.c_str());
+    return 0;
+}
+/**
+ * @brief Worker loop: takes queued connections and serves one request of each.
+ */
+void Server::worker()
+{
+    dcel_context *ctx = dcel_create();
+    double wx[] = {0, 0, 1, 1}, wy[] = {0, 1, 1, 0};
+    dcel_decompose(ctx, wx, wy, 4);
+    dcel_set_budget(ctx, this->budget_ms, this->budget_iterations);
+    while (true)
+    {
+        pair<int, clock::time_point> job;
+        {
+            unique_lock<mutex> lock(this->mu);
+            this->cv.wait(lock, [&] { return this->stopping || this->jobs.size(); });
+            if (this->stopping)
+            {
+                break;
+            }
+            job = this->jobs.front();
+            this->jobs.pop_front();
+            this->queue_depth--;
+        }
+        if (this->serve(job.first, ctx, job.second))
+        {
+            lock_guard<mutex> lock(this->mu);
+            this->returned.push_back(job.first);
+            char c = 0;
+            if (write(this->wake[1], &c, 1) < 0)
+            {
+                perror("dceld");
+            }
+        }
+        else
+        {
+            close(job.first);
+        }
+    }
+    dcel_destroy(ctx);
+}
+/**
+ * @brief Reads one request from a connection and replies to it.
+ *
+ * @param fd the connection
+ * @param ctx the context of the worker
+ * @param queued when the connection was queued, the start of the measured latency
+ * @return true if the connection stays open for more requests.
+ * @return false if it has to be closed.
+ */
+bool Server::serve(int fd, dcel_context *ctx, clock::time_point queued)
+{
+    clock::time_point deadline = clock::now() + chrono::milliseconds(this->timeout_ms);
+    uint32_t type;
+    if (!read_all(fd, &type, 4, deadline))
+    {
+        return false;
+    }
+    if (type == STATS)
+    {
+        string s = this->stats();
+        uint32_t len = s.size();
+        return write_all(fd, &len, 4) && write_all(fd, s.data(), len);
+    }
+    if (type == SHUTDOWN)
+    {
+        int32_t ok = 0;
+        write_all(fd, &ok, 4);
+        this->stopping = true;
+        char c = 0;
+        if (write(this->wake[1], &c, 1) < 0)
+        {
+            perror("dceld");
+        }
+        return false;
+    }
+    uint32_t n;
+    if (type != DECOMPOSE || !read_all(fd, &n, 4, deadline) || n > MAX_VERTICES)
+    {
+        return false;
+    }
+    thread_local vector<double> xs, ys;
+    xs.resize(n);
+    ys.resize(n);
+    if (!read_all(fd, xs.data(), n * sizeof(double), deadline) ||
+        !read_all(fd, ys.data(), n * sizeof(double), deadline))
+    {
+        return false;
+    }
+    int32_t k = dcel_decompose(ctx, xs.data(), ys.data(), n);
+    this->budget_hits += dcel_budget_hit(ctx);
+    bool ok;
+    if (k < 0)
+    {
+        string msg = dcel_error(ctx);
+        uint32_t len = msg.size();
+        ok = write_all(fd, &k, 4) && write_all(fd, &len, 4) && write_all(fd, msg.data(), len);
+        this->failures++;
+    }
+    else
+    {
+        const int *off = dcel_piece_offsets(ctx);
+        uint32_t total = off[k];
+        ok = write_all(fd, &k, 4) && write_all(fd, &total, 4) && write_all(fd, off, (k + 1) * sizeof(int)) &&
+             write_all(fd, dcel_piece_indices(ctx), total * sizeof(int));
+    }
+    this->requests++;
+    this->latency.add(chrono::duration<double, micro>(clock::now() - queued).count());
+    return ok;
+}
+/**
+ * @brief The counters of the server as a JSON object.
+ */
+string Server::stats()
+{
+    ostringstream s;
+    s << "{\"requests\": " << this->requests << ", \"failures\": " << this->failures
+      << ", \"budget_hits\": " << this->budget_hits
+      << ", \"queue_depth\": " << this->queue_depth << ", \"max_queue_depth\": " << this->max_queue_depth
+      << ", \"workers\": " << this->threads << ", \"p50_us\": " << this->latency.percentile(0.5)
+      << ", \"p99_us\": " << this->latency.percentile(0.99) << "}";
+    return s.str();
+}
+/**
+ * @brief Sends the polygon of a file count times and prints the pieces of the last reply.
+ *
+ * @return 0 on success
+ */
+int run_client(const string &path, const string &file, int count)
+{
+    ifstream in(file);
+    uint32_t n = 0;
+    in >> n;
+    vector<double> xs(n), ys(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        in >> xs[i] >> ys[i];
+    }
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        perror("dceld");
+        return 1;
+    }
+    vector<int32_t> off, idx;
+    int32_t k = -1;
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < count; r++)
+    {
+        uint32_t type = DECOMPOSE, total = 0;
+        if (!write_all(fd, &type, 4) || !write_all(fd, &n, 4) || !write_all(fd, xs.data(), n * sizeof(double)) ||
+            !write_all(fd, ys.data(), n * sizeof(double)) || !read_all(fd, &k, 4) || !read_all(fd, &total, 4))
+        {
+            cerr << "Connection lost\n";
+            close(fd);
+            return 1;
+        }
+        if (k < 0)
+        {
+            string msg(total, ' ');
+            read_all(fd, msg.data(), total);
+            cerr << "Failed: " << msg << "\n";
+            close(fd);
+            return 1;
+        }
+        off.resize(k + 1);
+        idx.resize(total);
+        read_all(fd, off.data(), off.size() * 4);
+        read_all(fd, idx.data(), idx.size() * 4);
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    close(fd);
+    cout << k << " pieces, " << ms / count << " ms per request\n";
+    for (int p = 0; p < k; p++)
+    {
+        for (int i = off[p]; i < off[p + 1]; i++)
+        {
+            cout << idx[i] << (i + 1 < off[p + 1] ? " " : "\n");
+        }
+    }
+    return 0;
+}
+/**
+ * @brief Sends a request without a body and prints the reply; used for stats and shutdown.
+ *
+ * @return 0 on success
+ */
+int run_simple(const string &path, uint32_t type)
+{
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        perror("dceld");
+        return 1;
+    }
+    uint32_t len = 0;
+    bool ok = write_all(fd, &type, 4) && read_all(fd, &len, 4);
+    if (ok && type == STATS)
+    {
+        string s(len, ' ');
+        ok = read_all(fd, s.data(), len);
+        cout << s << "\n";
+    }
+    close(fd);
+    return ok ? 0 : 1;
+}
+/**
+ * @brief Runs the server or one of the client commands listed at the top of the file.
+ *
+ * @return 0 if the program executes successfully
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " serve|client|stats|shutdown SOCKET [...]\n";
+        return 1;
+    }
+    string cmd = argv[1], path = argv[2];
+    if (cmd == "serve")
+    {
+        int a = 3;
+        int threads = argc > a && argv[a][0] != '-' ? atoi(argv[a++]) : max(1u, thread::hardware_concurrency());
+        Server server(path, threads);
+        for (; a + 1 < argc; a += 2)
+        {
+            string opt = argv[a];
+            if (opt == "--budget-ms")
+            {
+                server.budget_ms = atof(argv[a + 1]);
+            }
+            else if (opt == "--budget-iterations")
+            {
+                server.budget_iterations = atoll(argv[a + 1]);
+            }
+            else if (opt == "--timeout-ms")
+            {
+                server.timeout_ms = max(1, atoi(argv[a + 1]));
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (a < argc)
+        {
+            cerr << "Unknown option " << argv[a] << "\n";
+            return 1;
+        }
+        return server.run();
+    }
+    if (cmd == "client")
+    {
+        return run_client(path, argc > 3 ? argv[3] : "input.txt", argc > 4 ? max(1, atoi(argv[4])) : 1);
+    }
+    if (cmd == "stats")
+    {
+        return run_simple(path, STATS);
+    }
+    if (cmd == "shutdown")
+    {
+        return run_simple(path, SHUTDOWN);
+    }
+    cerr << "Unknown command " << cmd << "\n";
+    return 1;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file dcel.h
+ * @brief C interface of libdcel: decomposition of a simple polygon into convex pieces, without any file I/O.
+ *
+ * Build the library with
+ *     g++ -O2 -shared -fPIC -fvisibility=hidden dcel_capi.cpp -o libdcel.so -Wl,--version-script=dcel.map
+ * Only the functions below are exported: DCEL_API marks them, and dcel.map hides the C++ template
+ * instantiations that -fvisibility=hidden leaves visible (libstdc++ gives namespace std default visibility).
+ *
+ * A context holds the buffers of one decomposition and is reused by the next call on it. Different contexts
+ * can be used from different threads at the same time; a single context must not be used by two threads at once.
+ *
+ *     dcel_context* ctx = dcel_create();
+ *     int k = dcel_decompose(ctx, xs, ys, n);
+ *     const int* off = dcel_piece_offsets(ctx);  // piece i is dcel_piece_indices(ctx)[off[i] .. off[i+1])
+ *     const double* area = dcel_piece_attribute(ctx, DCEL_AREA);  // area[i] is the area of piece i
+ *     ...
+ *     dcel_destroy(ctx);
+ */
+#ifndef DCEL_C_H
+#define DCEL_C_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define DCEL_API __attribute__((visibility("default")))
+#else
+#define DCEL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dcel_context dcel_context;
+/**
+ * @brief Attributes computed for every piece, see dcel_piece_attribute().
+ */
+enum dcel_attribute
+{
+    DCEL_AREA,       /* area, positive */
+    DCEL_CENTROID_X, /* centroid of the area */
+    DCEL_CENTROID_Y,
+    DCEL_MIN_X,      /* bounding box */
+    DCEL_MIN_Y,
+    DCEL_MAX_X,
+    DCEL_MAX_Y,
+    DCEL_ATTRIBUTES  /* number of attributes */
+};
+
+/**
+ * @brief Creates a context.
+ *
+ * @return the context, or NULL if it could not be allocated
+ */
+DCEL_API dcel_context* dcel_create(void);
+/**
+ * @brief Frees a context and every buffer it owns.
+ */
+DCEL_API void dcel_destroy(dcel_context* ctx);
+/**
+ * @brief Decomposes a simple polygon into convex pieces. The vertices may be given in either orientation.
+ *
+ * @param ctx the context, whose previous result is discarded
+ * @param x x-coordinates of the vertices
+ * @param y y-coordinates of the vertices
+ * @param n number of vertices, at least 3
+ * @return number of pieces, or -1 on failure (see dcel_error); after a failure the context holds no pieces and
+ * no attributes
+ */
+DCEL_API int dcel_decompose(dcel_context* ctx, const double* x, const double* y, int n);
+/**
+ * @brief Bounds the time and the iterations split() may spend on the following decompositions. Once either is
+ * spent, the rest of the polygon is triangulated by ear clipping and merged as usual.
+ *
+ * @param ctx the context
+ * @param ms time budget in milliseconds, 0 for no limit
+ * @param iterations iteration budget, 0 for no limit
+ */
+DCEL_API void dcel_set_budget(dcel_context* ctx, double ms, long long iterations);
+/**
+ * @brief Whether the last decomposition ran out of its budget: 1 if it did, 0 otherwise.
+ */
+DCEL_API int dcel_budget_hit(const dcel_context* ctx);
+/**
+ * @brief Number of pieces of the last decomposition.
+ */
+DCEL_API int dcel_piece_count(const dcel_context* ctx);
+/**
+ * @brief Offsets of the pieces in dcel_piece_indices(), piece_count + 1 entries. Owned by the context and valid
+ * until its next dcel_decompose() or dcel_destroy().
+ */
+DCEL_API const int* dcel_piece_offsets(const dcel_context* ctx);
+/**
+ * @brief Vertex indices of all the pieces, one piece after the other, as positions in the x/y arrays that were
+ * passed in. Owned by the context, with the same lifetime as dcel_piece_offsets().
+ */
+DCEL_API const int* dcel_piece_indices(const dcel_context* ctx);
+/**
+ * @brief One attribute of all the pieces, piece_count entries in the order of dcel_piece_offsets(), computed in
+ * the same pass that lays the pieces out. Owned by the context, with the same lifetime as dcel_piece_offsets().
+ *
+ * @param ctx the context
+ * @param attribute one of dcel_attribute
+ * @return the column, or NULL for an unknown attribute or when the context holds no pieces
+ */
+DCEL_API const double* dcel_piece_attribute(const dcel_context* ctx, int attribute);
+/**
+ * @brief Copies the last result to caller provided buffers.
+ *
+ * @param ctx the context
+ * @param offsets receives piece_count + 1 offsets, may be NULL
+ * @param offsets_cap capacity of offsets
+ * @param indices receives the vertex indices of the pieces, may be NULL
+ * @param indices_cap capacity of indices
+ * @return number of vertex indices in the result; nothing is copied to a buffer that is too small for it
+ */
+DCEL_API size_t dcel_copy_pieces(const dcel_context* ctx, int* offsets, size_t offsets_cap, int* indices,
+                                 size_t indices_cap);
+/**
+ * @brief Message describing why the last dcel_decompose() on the context failed, "" if it did not.
+ */
+DCEL_API const char* dcel_error(const dcel_context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
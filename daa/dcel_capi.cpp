@@ -0,0 +1,181 @@
+/**
+ * @file dcel_capi.cpp
+ * @brief Implementation of the C interface declared in dcel.h, on top of DCEL.hpp.
+ *
+ */
+#include <bits/stdc++.h>
+#include "DCEL.hpp"
+#include "dcel.h"
+using namespace std;
+/**
+ * @brief Buffers of one decomposition, reused from one call to the next.
+ */
+struct dcel_context
+{
+    vector<double> xs, ys;
+    vector<int> offsets;
+    vector<int> indices;
+    vector<double> attributes[DCEL_ATTRIBUTES]; // one column per dcel_attribute, one entry per piece
+    string error;
+    double budget_ms;
+    long long budget_iterations;
+    bool budget_hit;
+};
+
+/**
+ * @brief Discards the result of the previous decomposition: no pieces, no attributes, no error.
+ */
+static void clear_result(dcel_context* ctx)
+{
+    ctx->offsets.assign(1, 0);
+    ctx->indices.clear();
+    for (auto &c : ctx->attributes)
+    {
+        c.clear();
+    }
+    ctx->error.clear();
+    ctx->budget_hit = false;
+}
+
+extern "C" {
+
+dcel_context* dcel_create(void)
+{
+    try
+    {
+        dcel_context* ctx = new dcel_context;
+        ctx->offsets.push_back(0);
+        ctx->budget_ms = 0;
+        ctx->budget_iterations = 0;
+        ctx->budget_hit = false;
+        return ctx;
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+void dcel_destroy(dcel_context* ctx)
+{
+    delete ctx;
+}
+
+int dcel_decompose(dcel_context* ctx, const double* x, const double* y, int n)
+{
+    if (!ctx)
+    {
+        return -1;
+    }
+    clear_result(ctx);
+    if (!x || !y || n < 3)
+    {
+        ctx->error = "a polygon needs at least 3 vertices";
+        return -1;
+    }
+    try
+    {
+        ctx->xs.assign(x, x + n);
+        ctx->ys.assign(y, y + n);
+        DCEL dcel(n);
+        dcel.verbose = false;
+        dcel.split_budget_ms = ctx->budget_ms;
+        dcel.split_budget_iterations = ctx->budget_iterations;
+        dcel.build(ctx->xs, ctx->ys);
+        int m = 0;
+        dcel.split(n, m);
+        ctx->budget_hit = dcel.budget_hit;
+        dcel.merge(n, m);
+        dcel.compact();
+        vector<double>* columns[DCEL_ATTRIBUTES] = {&dcel.face_area, &dcel.face_cx, &dcel.face_cy, &dcel.face_minx,
+                                                    &dcel.face_miny, &dcel.face_maxx, &dcel.face_maxy};
+        for (int a = 0; a < DCEL_ATTRIBUTES; a++)
+        {
+            ctx->attributes[a].swap(*columns[a]);
+        }
+        for (auto &f : dcel.convex_faces())
+        {
+            for (auto v : f)
+            {
+                ctx->indices.push_back(dcel.source_id(v));
+            }
+            ctx->offsets.push_back(ctx->indices.size());
+        }
+    }
+    catch (exception &e)
+    {
+        // the attribute columns are swapped in before the pieces are laid out, so they may be filled already
+        clear_result(ctx);
+        ctx->error = e.what();
+        return -1;
+    }
+    catch (...)
+    {
+        clear_result(ctx);
+        ctx->error = "unknown error";
+        return -1;
+    }
+    return ctx->offsets.size() - 1;
+}
+
+void dcel_set_budget(dcel_context* ctx, double ms, long long iterations)
+{
+    if (ctx)
+    {
+        ctx->budget_ms = ms;
+        ctx->budget_iterations = iterations;
+    }
+}
+
+int dcel_budget_hit(const dcel_context* ctx)
+{
+    return ctx && ctx->budget_hit;
+}
+
+int dcel_piece_count(const dcel_context* ctx)
+{
+    return ctx ? ctx->offsets.size() - 1 : 0;
+}
+
+const int* dcel_piece_offsets(const dcel_context* ctx)
+{
+    return ctx ? ctx->offsets.data() : NULL;
+}
+
+const int* dcel_piece_indices(const dcel_context* ctx)
+{
+    return ctx ? ctx->indices.data() : NULL;
+}
+
+const double* dcel_piece_attribute(const dcel_context* ctx, int attribute)
+{
+    if (!ctx || attribute < 0 || attribute >= DCEL_ATTRIBUTES || ctx->attributes[attribute].empty())
+    {
+        return NULL;
+    }
+    return ctx->attributes[attribute].data();
+}
+
+size_t dcel_copy_pieces(const dcel_context* ctx, int* offsets, size_t offsets_cap, int* indices, size_t indices_cap)
+{
+    if (!ctx)
+    {
+        return 0;
+    }
+    if (offsets && offsets_cap >= ctx->offsets.size())
+    {
+        copy(ctx->offsets.begin(), ctx->offsets.end(), offsets);
+    }
+    if (indices && indices_cap >= ctx->indices.size())
+    {
+        copy(ctx->indices.begin(), ctx->indices.end(), indices);
+    }
+    return ctx->indices.size();
+}
+
+const char* dcel_error(const dcel_context* ctx)
+{
+    return ctx ? ctx->error.c_str() : "no context";
+}
+
+}
@@ -6,6 +6,14 @@
 #include <fstream>
 #include<chrono>
 #include "DCEL.hpp"
+#include "ResultCache.hpp"
+#include "Simplify.hpp"
+#include "Snapshot.hpp"
+#include "Portfolio.hpp"
+#include "Holes.hpp"
+#include "OutOfCore.hpp"
+#include "LevelOfDetail.hpp"
+#include "MemoryStats.hpp"
 
 using namespace std;
 /**
@@ -45,82 +53,379 @@ void print_dq(deque<Vertex *> q)
  * This function is the entry point for the program. It reads input from a file,
  * constructs a DCEL data structure to represent a polygon, splits the polygon
  * into convex polygons, merges any unnecessary diagonals, and outputs the final
- * DCEL to a file. The program takes no command-line arguments
+ * DCEL to a file.
+ * 
+ * Options:
+ *  - --cache DIR keeps the results in the cache directory DIR (see ResultCache); the polygon is then
+ *    decomposed in its canonical form. Results cut short by --budget-ms, --budget-iterations or the deadline of
+ *    --portfolio are not stored.
+ *  - --cache-limit BYTES sets the size limit of the cache, 64 MiB by default.
+ *  - --simplify TOL drops repeated and (nearly) collinear vertices closer than TOL to the simplified outline
+ *    before the DCEL is built (see simplify_polygon()). Point ids in output.txt stay those of the input.
+ *  - --budget-ms MS and --budget-iterations N bound the time and the iterations of split(); once either is
+ *    spent the part of the polygon that is left is triangulated by ear clipping (see DCEL::clip_ears()).
+ *  - --portfolio K runs split and merge from K start vertices on all the hardware threads and keeps the
+ *    decomposition with the fewest pieces (see portfolio_decompose()); --budget-ms is then its deadline.
+ *  - --save-split FILE writes the DCEL as split() leaves it to FILE (see save_snapshot()).
+ *  - --load-split FILE reads such a snapshot instead of input.txt and only runs the merge, to iterate on
+ *    merge() without splitting again.
+ *  - --pieces-bin FILE also writes the convex pieces with their area, centroid and bounding box to FILE in
+ *    binary (see save_pieces()).
+ * 
+ *  - --out-of-core COORDS PIECES decomposes the polygon of the binary file COORDS (x y pairs of doubles) without
+ *    loading it: memory holds one chunk, a window of the file and the slab crossings (see
+ *    decompose_out_of_core()). The pieces
+ *    go to PIECES, one line of vertex ids each, and the points the slab cuts insert to PIECES.points.
+ *    --max-rss-mb MB (64 by default) bounds the memory it uses and --chunk N (4096 by default) the vertices
+ *    decomposed at once.
+ * 
+ *  - --lod T1,T2,... FILE decomposes the outer ring of input.txt simplified at every tolerance Ti, the levels
+ *    nested and each built from the coarser one (see decompose_levels()), and writes all of them to FILE (see
+ *    write_levels()).
+ * 
+ * input.txt may go on with the holes of the polygon: their number, then each hole in the same format as the
+ * outer ring. They are joined to the outer ring by bridges (see bridge_holes()); point ids count the vertices
+ * of all the rings one ring after the other, followed by the points where bridges end inside edges.
+ * 
+ * Built with -DMEMORY_STATS, the allocations of every phase (parse, build, split, faces, merge, compact, output)
+ * are printed after the elapsed time, see MemoryStats; without it the allocator is left alone.
  * 
  * @return 0 if the program executes successfully 
  */
-int main()
+int main(int argc, char** argv)
 {
     double t1,t2;
+    string cache_dir;
+    long long cache_limit = 64LL << 20;
+    double tolerance = -1;
+    string save_path, load_path, pieces_path;
+    double budget_ms = 0;
+    long long budget_iterations = 0;
+    int portfolio = 1;
+    string ooc_input, ooc_output;
+    vector<double> lod_tolerances;
+    string lod_output;
+    long long max_rss_mb = 64, chunk = 4096;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--cache" && i + 1 < argc)
+        {
+            cache_dir = argv[++i];
+        }
+        else if (arg == "--cache-limit" && i + 1 < argc)
+        {
+            cache_limit = atoll(argv[++i]);
+        }
+        else if (arg == "--simplify" && i + 1 < argc)
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else if (arg == "--budget-ms" && i + 1 < argc)
+        {
+            budget_ms = atof(argv[++i]);
+        }
+        else if (arg == "--budget-iterations" && i + 1 < argc)
+        {
+            budget_iterations = atoll(argv[++i]);
+        }
+        else if (arg == "--portfolio" && i + 1 < argc)
+        {
+            portfolio = atoi(argv[++i]);
+        }
+        else if (arg == "--save-split" && i + 1 < argc)
+        {
+            save_path = argv[++i];
+        }
+        else if (arg == "--load-split" && i + 1 < argc)
+        {
+            load_path = argv[++i];
+        }
+        else if (arg == "--pieces-bin" && i + 1 < argc)
+        {
+            pieces_path = argv[++i];
+        }
+        else if (arg == "--out-of-core" && i + 2 < argc)
+        {
+            ooc_input = argv[++i];
+            ooc_output = argv[++i];
+        }
+        else if (arg == "--lod" && i + 2 < argc)
+        {
+            stringstream list(argv[++i]);
+            string tol;
+            while (getline(list, tol, ','))
+            {
+                lod_tolerances.push_back(atof(tol.c_str()));
+            }
+            lod_output = argv[++i];
+        }
+        else if (arg == "--max-rss-mb" && i + 1 < argc)
+        {
+            max_rss_mb = max(1LL, atoll(argv[++i]));
+        }
+        else if (arg == "--chunk" && i + 1 < argc)
+        {
+            chunk = atoll(argv[++i]);
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if (!ooc_input.empty())
+    {
+        // a quarter of the budget for the mapped window, a quarter for a chunk at about 512 bytes a vertex
+        OutOfCoreOptions opt;
+        opt.window_bytes = (max_rss_mb << 20) / 4;
+        opt.chunk = min(chunk, max(64LL, (max_rss_mb << 20) / 4 / 512));
+        ofstream pieces(ooc_output), points(ooc_output + ".points");
+        if (!pieces || !points)
+        {
+            cerr << "Cannot write " << ooc_output << "\n";
+            return 1;
+        }
+        auto t0 = chrono::steady_clock::now();
+        try
+        {
+            OutOfCoreStats st = decompose_out_of_core(ooc_input, opt, pieces, points);
+            cout << st.pieces << " pieces from " << st.chunks << " chunks in " << st.slabs << " slabs, "
+                 << st.inserted << " inserted points, " << st.passes << " passes";
+            if (st.oversized)
+            {
+                cout << ", " << st.oversized << " vertices in chunks over " << opt.chunk;
+            }
+            cout << "\nElapsed time: " << chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count()
+                 << " milli seconds, peak rss " << MemoryStats::peak_rss_kb() << " kB" << endl;
+        }
+        catch (exception &e)
+        {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!lod_output.empty())
+    {
+        fin >> n;
+        vector<double> xs(n), ys(n);
+        for (int i = 0; i < n; i++)
+        {
+            fin >> xs[i] >> ys[i];
+        }
+        ofstream out(lod_output);
+        if (!fin || n < 3 || lod_tolerances.empty() || !out)
+        {
+            cerr << "Cannot decompose input.txt into the levels of " << lod_output << "\n";
+            return 1;
+        }
+        auto t0 = chrono::steady_clock::now();
+        vector<LodLevel> levels = decompose_levels(xs, ys, lod_tolerances);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        write_levels(out, levels);
+        for (auto &level : levels)
+        {
+            cout << "Tolerance " << level.tolerance << ": " << level.ids.size() << " vertices, " << level.pieces.size()
+                 << " pieces, " << level.reused << " of them reused, " << level.decomposed << " of " << level.regions
+                 << " regions decomposed, " << level.ms << " milli seconds" << endl;
+        }
+        cout << "Elapsed time: " << ms << " milli seconds" << endl;
+        return 0;
+    }
+    ResultCache *cache = cache_dir.empty() ? NULL : new ResultCache(cache_dir, cache_limit);
 
     auto start_time = chrono::high_resolution_clock::now();
     
-    fin >> n;
-
-    DCEL *root = new DCEL(n);
+    DCEL *root;
     /**
      * @param m  number of diagonals in DCEL
-     * 
-     */
+     * 
+     */
     int m = 0; // number of diagonals
     /**
      * @param np number of convex polygons
-     * 
-     */
+     * 
+     */
     int np;// number of convex polygons
-    for (int i = 0; i < n; i++)
+    vector<pair<int,int>> cached_diags;
+    vector<bool> cached_removed;
+    bool hit = false;
+    if (!load_path.empty())
     {
-        double x, y;
-        fin >> x >> y;
-        Vertex *v = new Vertex(i, x, y, NULL);
-        root->vertices[i] = v;
+        MemoryStats::phase("build");
+        root = load_snapshot(load_path, m);
+        if (!root)
+        {
+            cerr << "Cannot read the snapshot " << load_path << "\n";
+            return 1;
+        }
+        n = root->vertices.size();
     }
- 
-    for (int i = 0; i < n; i++)
+    else
     {
- 
-        Edge *e1 = new Edge(root->vertices[i], NULL, NULL, NULL, NULL);
-        Edge *e2 = new Edge(root->vertices[(i + 1) % n], NULL, NULL, NULL, NULL);
-        
-        e1->twin = e2;
-        e2->twin = e1;
-        root->edges[i] = e1;
-        root->twin_edges[i]=e2;
- 
-        root->vertices[i]->inc_edge = e1;
-      
- 
-       
-    }
-    for (int i = 0; i < n; ++i)
-    {
- 
-        root->edges[i]->next = root->edges[(i + 1) % n];
-        root->edges[(i + 1) % n]->prev = root->edges[i];
+        MemoryStats::phase("parse");
+        fin >> n;
+        vector<double> xs(n), ys(n);
+        for (int i = 0; i < n; i++)
+        {
+            fin >> xs[i] >> ys[i];
+        }
+        vector<int> ids(n);
+        iota(ids.begin(), ids.end(), 0);
+        int holes = 0;
+        if (fin >> holes && holes > 0)
+        {
+            vector<vector<double>> rx(holes + 1), ry(holes + 1);
+            rx[0] = xs;
+            ry[0] = ys;
+            for (int r = 1; r <= holes; r++)
+            {
+                int k;
+                fin >> k;
+                rx[r].resize(k);
+                ry[r].resize(k);
+                for (int i = 0; i < k; i++)
+                {
+                    fin >> rx[r][i] >> ry[r][i];
+                }
+            }
+            KeyholeBoundary kb = bridge_holes(rx, ry);
+            xs = kb.xs;
+            ys = kb.ys;
+            ids = kb.ids;
+            n = xs.size();
+            cout << "Bridged " << holes << " holes, " << n << " vertices on the boundary" << endl;
+        }
+        vector<int> kept(n);
+        iota(kept.begin(), kept.end(), 0);
+        if (tolerance >= 0)
+        {
+            kept = simplify_polygon(xs, ys, tolerance);
+            cout << "Simplified " << n << " vertices to " << kept.size() << endl;
+            vector<double> sx, sy;
+            for (int k : kept)
+            {
+                sx.push_back(xs[k]);
+                sy.push_back(ys[k]);
+            }
+            xs = sx;
+            ys = sy;
+            n = kept.size();
+        }
+
+        MemoryStats::phase("build");
+        root = new DCEL(n);
+        vector<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        if (cache)
+        {
+            order = ResultCache::canonical_order(xs, ys);
+        }
+        vector<double> ox(n), oy(n);
+        for (int i = 0; i < n; i++)
+        {
+            ox[i] = xs[order[i]];
+            oy[i] = ys[order[i]];
+        }
+        if (cache || tolerance >= 0 || holes > 0)
+        {
+            root->input_id.resize(n);
+            for (int i = 0; i < n; i++)
+            {
+                root->input_id[i] = ids[kept[order[i]]];
+            }
+        }
+        if (root->build(ox, oy))
+        {
+            cout << "Reversed the vertices to clockwise order" << endl;
+        }
+        hit = cache && cache->lookup(root, cached_diags, cached_removed);
     }
     // cout<<"No of faces before split = "<<root->faces.size()<<endl;
     //cout<<"Before Split\n";
+    MemoryStats::phase("split");
     auto a1 = chrono::high_resolution_clock::now();
-    root->split(n,m);
+    // with a portfolio the best run is replayed like a cache hit
+    bool replay = hit;
+    // a result cut short by a budget or a deadline is worse than what a later run may find, so it is not cached
+    bool degraded = false;
+    if (!hit && load_path.empty() && portfolio > 1)
+    {
+        PortfolioResult best = portfolio_decompose(root, portfolio, max(1u, thread::hardware_concurrency()), budget_ms);
+        cout << "Portfolio: best of " << best.runs << " runs starts at vertex " << root->source_id(root->vertices[best.start])
+             << " with " << best.pieces << " pieces" << (best.deadline_hit ? " (deadline hit)" : "") << endl;
+        cached_diags = best.diags;
+        cached_removed = best.removed;
+        degraded = best.deadline_hit;
+        delete best.dcel;
+        replay = true;
+    }
+    if (replay)
+    {
+        root->replay_split(cached_diags);
+        m = cached_diags.size();
+    }
+    else if (load_path.empty())
+    {
+        root->split_budget_ms = budget_ms;
+        root->split_budget_iterations = budget_iterations;
+        root->split(n,m);
+        if (root->budget_hit)
+        {
+            cout << "Split budget hit, the rest of the polygon was triangulated" << endl;
+            degraded = true;
+        }
+    }
     auto a2 = chrono::high_resolution_clock::now();
     t1 = chrono::duration<double>(a2 - a1).count() *1000;
+    if (!save_path.empty() && !save_snapshot(root, m, save_path))
+    {
+        cerr << "Cannot write the snapshot " << save_path << "\n";
+    }
    
+    MemoryStats::phase("faces");
     root->fout_the_split();
      // Algorithm to split the concave polygon into convex polygons
     root->summary_faces();
     // cout<<"Diagonals are "<<m<<"\n";
+    MemoryStats::phase("merge");
     auto b1 = chrono::high_resolution_clock::now();
-    root->merge(n,m); // Merge Algorithm to remove unnecessary diagonals
+    if (replay)
+    {
+        root->replay_merge(cached_removed);
+    }
+    else
+    {
+        root->merge(n,m); // Merge Algorithm to remove unnecessary diagonals
+    }
+    if (cache && !hit && load_path.empty() && !degraded)
+    {
+        cache->store(root);
+    }
     auto b2 = chrono::high_resolution_clock::now();
     t2 = chrono::duration<double>(b2 - b1).count() *1000;
     // cout<<"hi?\n";
+    MemoryStats::phase("compact");
+    root->compact();
+    MemoryStats::phase("output");
     root->fout_the_merge();
+    if (!pieces_path.empty() && !save_pieces(root, pieces_path))
+    {
+        cerr << "Cannot write the pieces " << pieces_path << "\n";
+    }
+    MemoryStats::finish();
     
  
     auto end_time = chrono::high_resolution_clock::now();
     double elapsed_time = chrono::duration<double>(end_time - start_time).count() *1000;
     cout << "Elapsed time: " << elapsed_time << " milli seconds" << endl;
     timing<<n<<" "<<elapsed_time<<"\n";
+    MemoryStats::report(cout);
+    if (cache)
+    {
+        cout << "Cache " << (hit ? "hit" : "miss") << ", hits = " << cache->hits << ", misses = " << cache->misses << ", evictions = " << cache->evictions << endl;
+    }
  
     return 0;
 }
\ No newline at end of file
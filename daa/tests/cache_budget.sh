@@ -0,0 +1,40 @@
+#!/bin/bash
+# Checks that a result cut short by the split budget or by the deadline of a portfolio is not stored in the
+# cache: a run with a tiny budget, then a run without one must miss the cache and decompose the polygon fully, like a run on an empty cache does.
+#
+# Run from daa/ as bash tests/cache_budget.sh; it prints OK or what went wrong and returns 1 on failure.
+set -u
+here=$(pwd)
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+g++ -O2 -pthread "$here/main.cpp" -o "$dir/main" 2> "$dir/build.log" || { cat "$dir/build.log"; exit 1; }
+# a star shaped polygon with 300 vertices, clockwise
+python3 - > "$dir/input.txt" <<'EOF'
+import math, random
+random.seed(7)
+n = 300
+print(n)
+for i in range(n):
+    a = 2 * math.pi * (n - i - random.uniform(0.1, 0.9)) / n
+    r = random.uniform(100, 250)
+    print(r * math.cos(a), r * math.sin(a))
+EOF
+cd "$dir"
+fail() { echo "FAILED: $1"; exit 1; }
+# with a cache the polygon is decomposed in its canonical form, so the reference run uses a cache too
+./main --cache fresh > plain.log && cp merge.txt plain.txt || fail "run on an empty cache"
+./main --cache cache --budget-iterations 1 > budget.log || fail "run with a budget"
+grep -q "Split budget hit" budget.log || fail "the budget was not hit"
+grep -q "Cache miss" budget.log || fail "the first run did not miss the cache"
+./main --cache cache > second.log || fail "second run"
+grep -q "Cache miss" second.log || fail "the second run got the degraded result from the cache"
+cmp -s merge.txt plain.txt || fail "the second run differs from a run on an empty cache"
+./main --cache cache > third.log || fail "third run"
+grep -q "Cache hit" third.log || fail "the full result was not cached"
+cmp -s merge.txt plain.txt || fail "the cached result differs from a run on an empty cache"
+./main --cache portfolio --portfolio 2 --budget-ms 0.001 > deadline.log || fail "portfolio run"
+grep -q "deadline hit" deadline.log || fail "the portfolio deadline was not hit"
+./main --cache portfolio > after.log || fail "run after the portfolio"
+grep -q "Cache miss" after.log || fail "the run after the portfolio got its degraded result from the cache"
+cmp -s merge.txt plain.txt || fail "the run after the portfolio differs from a run on an empty cache"
+echo OK
@@ -0,0 +1,46 @@
+#!/bin/bash
+# Checks that a damaged cache entry is a miss: a diagonal count that is too large for the polygon or for the file,
+# or a truncated entry, must neither abort main nor be replayed.
+#
+# Run from daa/ as bash tests/cache_corrupt.sh; it prints OK or what went wrong and returns 1 on failure.
+set -u
+here=$(pwd)
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+g++ -O2 -pthread "$here/main.cpp" -o "$dir/main" 2> "$dir/build.log" || { cat "$dir/build.log"; exit 1; }
+# a star shaped polygon with 300 vertices, clockwise
+python3 - > "$dir/input.txt" <<'EOF2'
+import math, random
+random.seed(7)
+n = 300
+print(n)
+for i in range(n):
+    a = 2 * math.pi * (n - i - random.uniform(0.1, 0.9)) / n
+    r = random.uniform(100, 250)
+    print(r * math.cos(a), r * math.sin(a))
+EOF2
+cd "$dir"
+fail() { echo "FAILED: $1"; exit 1; }
+./main --cache cache > first.log && cp merge.txt plain.txt || fail "run on an empty cache"
+entry=$(ls cache/*.dcc)
+cp "$entry" good.dcc
+size=$(stat -c %s good.dcc)
+# the diagonal count is the uint32 at offset 16
+for m in 4294967295 2147483648 536870912 301 $(( (size - 20) / 8 + 1 )); do
+    cp good.dcc "$entry"
+    python3 -c "import struct, sys; f = open(sys.argv[1], 'r+b'); f.seek(16); f.write(struct.pack('=I', int(sys.argv[2])))" \
+        "$entry" $m
+    ./main --cache cache > run.log 2>&1 || fail "main failed with a count of $m: $(tail -1 run.log)"
+    grep -q "Cache miss" run.log || fail "a count of $m was not a miss"
+    cmp -s merge.txt plain.txt || fail "the run with a count of $m differs from a run on an empty cache"
+done
+for len in 0 10 20 $(( size - 4 )); do
+    head -c $len good.dcc > "$entry"
+    ./main --cache cache > run.log 2>&1 || fail "main failed on an entry cut to $len bytes"
+    grep -q "Cache miss" run.log || fail "an entry cut to $len bytes was not a miss"
+    cmp -s merge.txt plain.txt || fail "the run on an entry cut to $len bytes differs from a run on an empty cache"
+done
+cp good.dcc "$entry"
+./main --cache cache > run.log || fail "run on the intact entry"
+grep -q "Cache hit" run.log || fail "the intact entry was not a hit"
+echo OK
@@ -0,0 +1,107 @@
+/**
+ * @file capi_errors.cpp
+ * @brief Checks that a dcel_decompose() that fails leaves no pieces and no attributes of the previous result in
+ * the context. The failures are bad_allocs from a replacement of operator new that fails the k-th allocation of
+ * the decomposition, for every k until it succeeds, so that every stage of it fails once.
+ *
+ * Build from daa/ with g++ -O2 tests/capi_errors.cpp dcel_capi.cpp -o capi_errors and run ./capi_errors; it
+ * prints every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../dcel.h"
+using namespace std;
+/**
+ * @brief Allocations left before operator new throws, -1 for never.
+ */
+static long long allocations_left = -1;
+
+void* operator new(size_t size)
+{
+    if (allocations_left >= 0 && allocations_left-- == 0)
+    {
+        throw bad_alloc();
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+int failures = 0;
+/**
+ * @brief Counts a failure and prints it when cond does not hold.
+ */
+void expect(bool cond, const string& what)
+{
+    if (!cond)
+    {
+        failures++;
+        cout << what << "\n";
+    }
+}
+/**
+ * @brief A clockwise star shaped polygon, like the ones of bench.cpp.
+ */
+void star(int n, unsigned seed, vector<double>& xs, vector<double>& ys)
+{
+    mt19937 rng(seed);
+    uniform_real_distribution<double> jitter(0.1, 0.9), radius(100, 250);
+    for (int i = 0; i < n; i++)
+    {
+        double ang = 2 * M_PI * (n - i - jitter(rng)) / n;
+        double r = radius(rng);
+        xs.push_back(r * cos(ang));
+        ys.push_back(r * sin(ang));
+    }
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    vector<double> xs, ys, bx, by;
+    star(20, 5, xs, ys);
+    star(60, 6, bx, by);
+    dcel_context* ctx = dcel_create();
+    long long k = 0;
+    for (;; k++)
+    {
+        expect(dcel_decompose(ctx, xs.data(), ys.data(), xs.size()) > 0 && dcel_piece_attribute(ctx, DCEL_AREA),
+               "the small polygon failed");
+        allocations_left = k;
+        int got = dcel_decompose(ctx, bx.data(), by.data(), bx.size());
+        allocations_left = -1;
+        if (got >= 0)
+        {
+            break;
+        }
+        string at = " when allocation " + to_string(k) + " failed";
+        expect(got == -1 && string(dcel_error(ctx)).size() > 0, "no error message" + at);
+        expect(dcel_piece_count(ctx) == 0, to_string(dcel_piece_count(ctx)) + " pieces" + at);
+        expect(dcel_piece_offsets(ctx)[0] == 0, "the offsets do not start at 0" + at);
+        expect(dcel_copy_pieces(ctx, NULL, 0, NULL, 0) == 0, "vertex indices left" + at);
+        expect(!dcel_budget_hit(ctx), "the budget is reported as hit" + at);
+        for (int a = 0; a < DCEL_ATTRIBUTES; a++)
+        {
+            expect(dcel_piece_attribute(ctx, a) == NULL, "attribute " + to_string(a) + " left" + at);
+        }
+    }
+    expect(k > 0, "no allocation failed");
+    expect(dcel_piece_count(ctx) > 0 && string(dcel_error(ctx)).empty(), "the context does not work afterwards");
+    dcel_destroy(ctx);
+
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#!/bin/bash
+# Checks that dceld drops a client that stalls in the middle of a request, so that the only worker is free
+# again for the next client, and that --budget-iterations reaches the decompositions of the server.
+#
+# Run from daa/ as bash tests/daemon.sh; it prints OK or what went wrong and returns 1 on failure.
+set -u
+here=$(pwd)
+dir=$(mktemp -d)
+server=
+trap 'if [ -n "$server" ]; then kill $server 2> /dev/null; fi; rm -rf "$dir"' EXIT
+g++ -O2 -shared -fPIC -fvisibility=hidden "$here/dcel_capi.cpp" -o "$dir/libdcel.so" \
+    -Wl,--version-script="$here/dcel.map" 2> "$dir/build.log" &&
+    g++ -O2 -pthread "$here/daemon.cpp" -o "$dir/dceld" -L"$dir" -ldcel -Wl,-rpath,"$dir" 2>> "$dir/build.log" ||
+    { cat "$dir/build.log"; exit 1; }
+# a star shaped polygon with 300 vertices, clockwise
+python3 - > "$dir/input.txt" <<'PY'
+import math, random
+random.seed(7)
+n = 300
+print(n)
+for i in range(n):
+    a = 2 * math.pi * (n - i - random.uniform(0.1, 0.9)) / n
+    r = random.uniform(100, 250)
+    print(r * math.cos(a), r * math.sin(a))
+PY
+cd "$dir"
+fail() { echo "FAILED: $1"; exit 1; }
+start() {
+    ./dceld serve sock 1 "$@" > server.log &
+    server=$!
+    for i in $(seq 50); do [ -S sock ] && return; sleep 0.1; done
+    fail "the server did not start"
+}
+stop() {
+    ./dceld shutdown sock > /dev/null
+    wait $server
+    server=
+}
+
+start --timeout-ms 300
+# sends the header of a request and half of its x-coordinates, then waits for the server to close the connection
+python3 - > stall.log <<'PY' &
+import socket, struct, time
+s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+s.connect("sock")
+s.sendall(struct.pack("=II", 1, 100) + b"\0" * 400)
+t = time.time()
+s.settimeout(10)
+try:
+    closed = s.recv(1) == b""
+except socket.timeout:
+    closed = False
+print("closed" if closed else "open", time.time() - t)
+PY
+stall=$!
+sleep 0.1
+timeout 5 ./dceld client sock input.txt > plain.log || fail "the client behind the stalled one was not served"
+wait $stall
+grep -q "^closed" stall.log || fail "the stalled connection was not closed"
+stop
+
+start --budget-iterations 1
+timeout 5 ./dceld client sock input.txt > budget.log || fail "the request with a budget failed"
+./dceld stats sock > stats.log
+grep -q '"budget_hits": 1' stats.log || fail "the budget was not hit: $(cat stats.log)"
+stop
+echo OK
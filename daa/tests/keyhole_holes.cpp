@@ -0,0 +1,197 @@
+/**
+ * @file keyhole_holes.cpp
+ * @brief Decomposes polygons with many holes through bridge_holes() and checks the pieces: the holes are unit
+ * squares and diamonds at integer coordinates, so bridges run along hole edges and through hole vertices. Every
+ * piece has to be convex, the pieces have to add up to the area between the rings, and sample points have to be
+ * covered once outside the holes and not at all inside them.
+ *
+ * Build from daa/ with g++ -O2 tests/keyhole_holes.cpp -o keyhole_holes and run ./keyhole_holes there; it prints
+ * every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../Holes.hpp"
+using namespace std;
+
+int failures = 0;
+/**
+ * @brief Rings of a w x w square with holes, the outer ring first.
+ */
+struct Rings
+{
+    vector<vector<double>> xs, ys;
+    double w, holes; // side of the square, area of the holes
+
+    void add(const vector<double>& x, const vector<double>& y, double area)
+    {
+        xs.push_back(x);
+        ys.push_back(y);
+        holes += area;
+    }
+};
+/**
+ * @brief A unit square with its lower left corner at (x, y), or a diamond of radius 1 centred at (x + 1, y + 1).
+ */
+void add_hole(Rings& r, double x, double y, bool diamond)
+{
+    if (diamond)
+    {
+        r.add({x, x + 1, x + 2, x + 1}, {y + 1, y, y + 1, y + 2}, 2);
+    }
+    else
+    {
+        r.add({x, x + 1, x + 1, x}, {y, y, y + 1, y + 1}, 1);
+    }
+}
+/**
+ * @brief A square of side w with count holes at random integer positions, at least 1 apart.
+ */
+Rings scattered(int w, int count, unsigned seed)
+{
+    mt19937 rng(seed);
+    Rings r = {{{0, 0, (double)w, (double)w}}, {{0, (double)w, (double)w, 0}}, (double)w, 0};
+    vector<array<int, 4>> boxes;
+    for (int tries = 0; (int)boxes.size() < count && tries < 100000; tries++)
+    {
+        bool diamond = rng() % 2;
+        int x = 1 + rng() % (w - 3), y = 1 + rng() % (w - 3), side = diamond ? 2 : 1;
+        array<int, 4> b = {x, y, x + side, y + side};
+        bool apart = b[2] < w && b[3] < w;
+        for (auto &o : boxes)
+        {
+            apart = apart && (b[0] > o[2] || o[0] > b[2] || b[1] > o[3] || o[1] > b[3]);
+        }
+        if (apart)
+        {
+            boxes.push_back(b);
+            add_hole(r, x, y, diamond);
+        }
+    }
+    return r;
+}
+/**
+ * @brief A square of cells x cells cells of side 4, percent of them holding a hole; the holes of a row line up.
+ */
+Rings grid(int cells, int percent, unsigned seed)
+{
+    mt19937 rng(seed);
+    double w = 4 * cells;
+    Rings r = {{{0, 0, w, w}}, {{0, w, w, 0}}, w, 0};
+    for (int i = 0; i < cells; i++)
+    {
+        for (int j = 0; j < cells; j++)
+        {
+            if ((int)(rng() % 100) < percent)
+            {
+                bool diamond = rng() % 2;
+                add_hole(r, 4 * i + 1 + (diamond ? 0 : rng() % 2), 4 * j + 1 + (diamond ? 0 : rng() % 2), diamond);
+            }
+        }
+    }
+    return r;
+}
+/**
+ * @brief Whether a point lies inside a ring, by the crossings of a ray to its right.
+ */
+bool in_ring(const vector<double>& xs, const vector<double>& ys, double px, double py)
+{
+    bool in = false;
+    int k = xs.size();
+    for (int i = 0, j = k - 1; i < k; j = i++)
+    {
+        if ((ys[i] > py) != (ys[j] > py) && px < xs[i] + (py - ys[i]) * (xs[j] - xs[i]) / (ys[j] - ys[i]))
+        {
+            in = !in;
+        }
+    }
+    return in;
+}
+/**
+ * @brief Splits and merges the keyhole boundary of the rings and checks the pieces.
+ */
+void check(const string& name, const Rings& r)
+{
+    DCEL* d = build_with_holes(r.xs, r.ys);
+    d->verbose = false;
+    int n = d->vertices.size(), m = 0;
+    d->split(n, m);
+    d->merge(n, m);
+    vector<vector<Vertex*>> pieces = d->convex_faces();
+    double total = 0;
+    int concave = 0;
+    for (auto &f : pieces)
+    {
+        int k = f.size();
+        double area = 0;
+        bool convex = k >= 3;
+        for (int i = 0; i < k; i++)
+        {
+            Vertex *a = f[i], *b = f[(i + 1) % k], *c = f[(i + 2) % k];
+            area += a->x * b->y - b->x * a->y;
+            convex = convex && (b->x - a->x) * (c->y - b->y) - (b->y - a->y) * (c->x - b->x) <= 0;
+        }
+        total -= area / 2;
+        concave += !convex;
+    }
+    double expected = r.w * r.w - r.holes;
+    if (concave)
+    {
+        failures++;
+        cout << name << ": " << concave << " of " << pieces.size() << " pieces are not convex\n";
+    }
+    if (fabs(total - expected) > 1e-9 * expected)
+    {
+        failures++;
+        cout << name << ": the pieces cover " << total << ", the polygon " << expected << "\n";
+    }
+    mt19937 rng(n);
+    uniform_real_distribution<double> at(0, r.w);
+    int wrong = 0;
+    for (int t = 0; t < 2000; t++)
+    {
+        double px = at(rng), py = at(rng);
+        int want = 1, got = 0;
+        for (size_t h = 1; h < r.xs.size(); h++)
+        {
+            want = want && !in_ring(r.xs[h], r.ys[h], px, py);
+        }
+        for (auto &f : pieces)
+        {
+            int k = f.size();
+            bool in = true;
+            for (int i = 0; i < k && in; i++)
+            {
+                Vertex *a = f[i], *b = f[(i + 1) % k];
+                in = (b->x - a->x) * (py - a->y) - (px - a->x) * (b->y - a->y) <= 0;
+            }
+            got += in;
+        }
+        wrong += got != want;
+    }
+    if (wrong)
+    {
+        failures++;
+        cout << name << ": " << wrong << " sample points are covered by the wrong number of pieces\n";
+    }
+    delete d;
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    for (unsigned seed = 0; seed < 100; seed++)
+    {
+        check("12x12, 6 holes, seed " + to_string(seed), scattered(12, 6, seed));
+        check("32x32, 8 holes, seed " + to_string(seed), scattered(32, 8, seed));
+        check("32x32, 40 holes, seed " + to_string(seed), scattered(32, 40, seed));
+    }
+    for (unsigned seed = 0; seed < 20; seed++)
+    {
+        check("grid 4, seed " + to_string(seed), grid(4, 60, seed));
+    }
+    check("grid 50", grid(50, 80, 1));
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file memory_stats.cpp
+ * @brief Checks that the operators of MemoryStats.hpp count plain, nothrow and over-aligned allocations, return
+ * blocks with the alignment asked for, and give every byte back when they are freed.
+ *
+ * Build from daa/ with g++ -O2 -DMEMORY_STATS tests/memory_stats.cpp -o memory_stats and run ./memory_stats;
+ * it prints every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../MemoryStats.hpp"
+using namespace std;
+
+struct alignas(64) Line
+{
+    double v[8];
+};
+struct alignas(4096) Page
+{
+    char v[100];
+};
+
+int failures = 0;
+/**
+ * @brief Counts a failure and prints it when cond does not hold.
+ */
+void expect(bool cond, const string& what)
+{
+    if (!cond)
+    {
+        failures++;
+        cout << what << "\n";
+    }
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    static_assert(MemoryStats::counting, "build with -DMEMORY_STATS");
+    long long before = MemoryStats::live();
+    MemoryStats::phase("test");
+    int* a = new int(1);
+    int* b = new int[10];
+    int* c = new (nothrow) int(2);
+    int* d = new (nothrow) int[10];
+    Line* e = new Line;
+    Line* f = new Line[3];
+    Page* g = new (nothrow) Page;
+    Page* h = new (nothrow) Page[2];
+    expect((uintptr_t)e % 64 == 0 && (uintptr_t)f % 64 == 0, "a Line is not aligned to 64 bytes");
+    expect((uintptr_t)g % 4096 == 0 && (uintptr_t)h % 4096 == 0, "a Page is not aligned to 4096 bytes");
+    long long held = MemoryStats::live() - before;
+    long long expected = 2 * sizeof(int) + 20 * sizeof(int) + sizeof(Line) + 3 * sizeof(Line) + 3 * sizeof(Page);
+    expect(held >= expected, "live heap grew by " + to_string(held) + " bytes, less than " + to_string(expected));
+    delete a;
+    delete[] b;
+    delete c;
+    delete[] d;
+    delete e;
+    delete[] f;
+    delete g;
+    delete[] h;
+    MemoryStats::finish();
+    long long after = MemoryStats::live();
+    expect(after == before, "live heap is " + to_string(after - before) + " bytes off after everything was freed");
+    auto p = MemoryStats::phases();
+    expect(p.size() == 1 && p[0].allocs >= 8, "the phase did not count the 8 allocations");
+
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
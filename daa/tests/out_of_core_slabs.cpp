@@ -0,0 +1,153 @@
+/**
+ * @file out_of_core_slabs.cpp
+ * @brief Checks decompose_out_of_core() on integer polygons, whose vertices often lie on the edges of the
+ * histogram bins choose_slabs() cuts the slabs at: every piece has to be convex, and the pieces together have
+ * to cover the polygon exactly.
+ *
+ * Build from daa/ with g++ -O2 tests/out_of_core_slabs.cpp -o out_of_core_slabs and run ./out_of_core_slabs
+ * there; it prints every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../OutOfCore.hpp"
+using namespace std;
+
+int failures = 0;
+/**
+ * @brief A star shaped polygon with integer coordinates, clockwise, without three collinear vertices: one point
+ * per angular sector, redrawn while it repeats a point or is collinear with two earlier ones.
+ */
+void integer_star(int n, unsigned seed, vector<double>& xs, vector<double>& ys)
+{
+    mt19937 rng(seed);
+    uniform_real_distribution<double> radius(40, 120);
+    vector<pair<double, pair<long long, long long>>> pts;
+    for (int i = 0; i < n; i++)
+    {
+        for (int attempt = 0; attempt < 50; attempt++)
+        {
+            double a = 2 * M_PI * i / n + uniform_real_distribution<double>(0, 2 * M_PI / n)(rng);
+            double r = radius(rng);
+            long long x = llround(r * cos(a)), y = llround(r * sin(a));
+            // the origin is the centre of the star, so it must not share a ray with another point either
+            bool ok = x != 0 || y != 0;
+            for (size_t j = 0; ok && j < pts.size(); j++)
+            {
+                auto p = pts[j].second;
+                ok = p.first * y != p.second * x || p.first * x + p.second * y < 0;
+                for (size_t k = j + 1; ok && k < pts.size(); k++)
+                {
+                    auto q = pts[k].second;
+                    ok = (q.first - p.first) * (y - p.second) != (q.second - p.second) * (x - p.first);
+                }
+            }
+            if (ok)
+            {
+                pts.push_back({-atan2((double)y, (double)x), {x, y}});
+                break;
+            }
+        }
+    }
+    sort(pts.begin(), pts.end());
+    xs.clear();
+    ys.clear();
+    for (auto &p : pts)
+    {
+        xs.push_back(p.second.first);
+        ys.push_back(p.second.second);
+    }
+}
+/**
+ * @brief Decomposes the polygon out of core and checks its pieces.
+ */
+void check(const string& name, const vector<double>& xs, const vector<double>& ys, long long chunk)
+{
+    string coords = "out_of_core_slabs.bin";
+    {
+        ofstream f(coords, ios::binary);
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            f.write((const char*)&xs[i], sizeof(double));
+            f.write((const char*)&ys[i], sizeof(double));
+        }
+    }
+    ostringstream out, points;
+    OutOfCoreOptions opt = {chunk, 1 << 16};
+    try
+    {
+        decompose_out_of_core(coords, opt, out, points);
+    }
+    catch (exception& e)
+    {
+        failures++;
+        cout << name << ": " << e.what() << "\n";
+        return;
+    }
+    remove(coords.c_str());
+    map<long long, pair<double, double>> at;
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        at[i] = {xs[i], ys[i]};
+    }
+    istringstream pin(points.str());
+    long long id;
+    double x, y;
+    while (pin >> id >> x >> y)
+    {
+        at[id] = {x, y};
+    }
+    double total = 0;
+    istringstream lines(out.str());
+    string line;
+    while (getline(lines, line))
+    {
+        vector<pair<double, double>> p;
+        istringstream ls(line);
+        while (ls >> id)
+        {
+            p.push_back(at[id]);
+        }
+        int m = p.size();
+        double area = 0;
+        bool convex = m >= 3;
+        for (int i = 0; i < m; i++)
+        {
+            auto a = p[i], b = p[(i + 1) % m], c = p[(i + 2) % m];
+            area += a.first * b.second - b.first * a.second;
+            // clockwise: every turn is to the right or straight
+            convex = convex && (b.first - a.first) * (c.second - b.second) - (b.second - a.second) * (c.first - b.first) <= 1e-9;
+        }
+        total -= area / 2;
+        if (!convex)
+        {
+            failures++;
+            cout << name << ": piece " << line << " is not convex\n";
+        }
+    }
+    double expected = 0;
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        size_t j = (i + 1) % xs.size();
+        expected -= (xs[i] * ys[j] - xs[j] * ys[i]) / 2;
+    }
+    if (fabs(total - expected) > 1e-6 * expected)
+    {
+        failures++;
+        cout << name << ": the pieces cover " << total << ", the polygon " << expected << "\n";
+    }
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    vector<double> xs, ys;
+    for (unsigned seed = 0; seed < 300; seed++)
+    {
+        integer_star(40 + seed % 200, seed, xs, ys);
+        check("seed " + to_string(seed), xs, ys, 16);
+    }
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
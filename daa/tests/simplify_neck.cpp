@@ -0,0 +1,55 @@
+/**
+ * @file simplify_neck.cpp
+ * @brief Checks that simplify_polygon() never returns an outline that crosses itself, on a polygon where dropping
+ * the repeated vertices at the full tolerance makes a chord cut through a narrow spike.
+ *
+ * Build from daa/ with g++ -O2 tests/simplify_neck.cpp -o simplify_neck and run ./simplify_neck there; it prints
+ * every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../Simplify.hpp"
+using namespace std;
+
+int failures = 0;
+/**
+ * @brief Counts a failure and prints it when cond does not hold.
+ */
+void expect(bool cond, const string& what)
+{
+    if (!cond)
+    {
+        failures++;
+        cout << what << "\n";
+    }
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    // vertex 1 is 0.1 from vertex 0; dropping it makes the edge 0 -> 2 cross the spike 4, 5, 6 whose tip is at
+    // x = 0.08, in the neck between x = 0 and x = 0.1
+    vector<double> xs = {0, 0.1, 0.1, -3, -3, 0.08, -3, -3, 0.1};
+    vector<double> ys = {0, 0, -3, -3, -0.6, -0.5, -0.4, 3, 3};
+    vector<int> all(xs.size());
+    iota(all.begin(), all.end(), 0);
+    expect(is_simple(xs, ys, all), "the input is not simple");
+    expect(!is_simple(xs, ys, drop_repeated(xs, ys, 0.15)), "dropping vertex 1 does not cross the spike");
+
+    vector<int> idx = simplify_polygon(xs, ys, 0.15);
+    expect(is_simple(xs, ys, idx), "simplify_polygon() returned an outline that crosses itself");
+    expect(find(idx.begin(), idx.end(), 1) != idx.end(), "simplify_polygon() dropped vertex 1");
+
+    // with any tolerance the result is simple, the input itself if nothing else is
+    for (double tol : {0.01, 0.15, 0.5, 1.0, 5.0, 50.0})
+    {
+        idx = simplify_polygon(xs, ys, tol);
+        expect(idx.size() >= 3 && is_simple(xs, ys, idx),
+               "simplify_polygon() with tolerance " + to_string(tol) + " returned an outline that is not simple");
+    }
+
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
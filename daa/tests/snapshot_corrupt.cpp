@@ -0,0 +1,133 @@
+/**
+ * @file snapshot_corrupt.cpp
+ * @brief Checks that load_snapshot() returns NULL, and neither throws nor allocates what a corrupt count asks
+ * for, on truncated and corrupted snapshots.
+ *
+ * Build from daa/ with g++ -O2 tests/snapshot_corrupt.cpp -o snapshot_corrupt and run ./snapshot_corrupt there
+ * (add -fsanitize=address to catch bad reads too); it prints every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../Snapshot.hpp"
+using namespace std;
+
+int failures = 0;
+string path;
+/**
+ * @brief Writes bytes to the scratch file and loads it.
+ *
+ * @return 1 if load_snapshot() gave a DCEL, 0 if it gave NULL, -1 if it threw
+ */
+int load(const string& bytes)
+{
+    ofstream(path, ios::binary).write(bytes.data(), bytes.size());
+    int m = 0;
+    try
+    {
+        DCEL* d = load_snapshot(path, m);
+        delete d;
+        return d != NULL;
+    }
+    catch (exception& e)
+    {
+        return -1;
+    }
+}
+/**
+ * @brief Counts a failure and prints it when loading bytes does not give the expected result.
+ */
+void expect(const string& name, const string& bytes, int expected)
+{
+    int got = load(bytes);
+    if (got != expected)
+    {
+        failures++;
+        cout << name << ": load_snapshot() " << (got < 0 ? "threw" : got ? "gave a DCEL" : "gave NULL") << "\n";
+    }
+}
+/**
+ * @brief Returns a copy of bytes with the 32-bit word at offset replaced by value.
+ */
+string patch(string bytes, size_t offset, unsigned int value)
+{
+    memcpy(&bytes[offset], &value, sizeof value);
+    return bytes;
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    path = "snapshot_corrupt.tmp";
+    int n = 60;
+    mt19937 rng(11);
+    uniform_real_distribution<double> jitter(0.1, 0.9), radius(100, 250);
+    vector<double> xs, ys;
+    for (int i = 0; i < n; i++)
+    {
+        double ang = 2 * M_PI * (n - i - jitter(rng)) / n;
+        double r = radius(rng);
+        xs.push_back(r * cos(ang));
+        ys.push_back(r * sin(ang));
+    }
+    DCEL dcel(n);
+    dcel.verbose = false;
+    dcel.build(xs, ys);
+    int m = 0;
+    dcel.split(n, m);
+    save_snapshot(&dcel, m, path);
+    string good;
+    {
+        ifstream in(path, ios::binary);
+        good.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    expect("the snapshot itself", good, 1);
+
+    unsigned int header[7];
+    memcpy(header, good.data(), sizeof header);
+    int E = header[2];
+    size_t ostart = sizeof header + 24 * n, out = ostart + 4 * (n + 1);
+    int K;
+    memcpy(&K, &good[ostart + 4 * n], sizeof K);
+    size_t org = out + 4 * K + 3 * 8 * E;
+
+    for (size_t len = 0; len < good.size(); len++)
+    {
+        expect("truncated to " + to_string(len) + " bytes", good.substr(0, len), 0);
+    }
+    const char* counts[] = {"n", "E", "F", "L"};
+    for (int c = 0; c < 4; c++)
+    {
+        for (unsigned int v : {0xffffffffu, 0x80000000u, 0x7fffffffu, 0x10000000u, (unsigned int)good.size()})
+        {
+            expect(string("header ") + counts[c] + " = " + to_string(v), patch(good, 4 * (c + 1), v), 0);
+        }
+    }
+    for (int v : {INT_MAX, INT_MAX / 4, (int)good.size(), -1})
+    {
+        expect("out_start[n] = " + to_string(v), patch(good, ostart + 4 * n, v), 0);
+    }
+    expect("vertex id -1", patch(good, sizeof header + 16 * n, -1), 0);
+    expect("vertex id n", patch(good, sizeof header + 16 * n, n), 0);
+    expect("origin -1", patch(good, org, -1), 0);
+    expect("origin n", patch(good, org, n), 0);
+    expect("twin 2E", patch(good, out + 4 * K, 2 * E), 0);
+
+    // any other word may or may not give a DCEL, but loading must not throw
+    uniform_int_distribution<size_t> word(0, good.size() / 4 - 1);
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        size_t at = 4 * word(rng);
+        unsigned int v = trial % 2 ? rng() : rng() % (2 * n);
+        if (load(patch(good, at, v)) < 0)
+        {
+            failures++;
+            cout << "word at " << at << " = " << v << ": load_snapshot() threw\n";
+        }
+    }
+    remove(path.c_str());
+
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
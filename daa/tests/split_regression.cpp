@@ -0,0 +1,154 @@
+/**
+ * @file split_regression.cpp
+ * @brief Pins the pieces split() and merge() give for the corpus and for polygons where the backtracking step of
+ * split() used to drop v1 from L.
+ *
+ * Build from daa/ with g++ -O2 tests/split_regression.cpp -o split_regression and run ./split_regression there;
+ * it prints every mismatch and returns 1 if there is one.
+ */
+#include <bits/stdc++.h>
+#include "../DCEL.hpp"
+using namespace std;
+/**
+ * @brief Pieces of a decomposition, with a hash of their input ids in the order convex_faces() gives them.
+ */
+struct Pieces
+{
+    size_t count;
+    int degenerate; // pieces with fewer than 3 vertices
+    unsigned long long hash;
+};
+/**
+ * @brief Runs split() and merge() on the polygon, through SmallPolygon when small is set and the polygon is
+ * small enough.
+ */
+Pieces decompose(vector<double> xs, vector<double> ys, bool small)
+{
+    int n = xs.size();
+    DCEL dcel(n);
+    dcel.verbose = false;
+    dcel.build(xs, ys);
+    dcel.use_small_path = dcel.use_small_path && small;
+    int m = 0;
+    dcel.split(n, m);
+    dcel.merge(n, m);
+    Pieces res = {0, 0, 1469598103934665603ULL};
+    for (auto &f : dcel.convex_faces())
+    {
+        res.count++;
+        res.degenerate += f.size() < 3;
+        for (auto v : f)
+        {
+            res.hash = (res.hash ^ dcel.source_id(v)) * 1099511628211ULL;
+        }
+        res.hash = (res.hash ^ 0xffff) * 1099511628211ULL;
+    }
+    return res;
+}
+/**
+ * @brief The star shaped polygons of bench.cpp.
+ */
+void random_polygon(int n, unsigned seed, vector<double>& xs, vector<double>& ys)
+{
+    mt19937 rng(seed);
+    uniform_real_distribution<double> jitter(0.1, 0.9), radius(100, 250);
+    xs.clear();
+    ys.clear();
+    for (int i = 0; i < n; i++)
+    {
+        double ang = 2 * M_PI * (n - i - jitter(rng)) / n;
+        double r = radius(rng);
+        xs.push_back(r * cos(ang));
+        ys.push_back(r * sin(ang));
+    }
+}
+
+int failures = 0;
+/**
+ * @brief Counts a failure and prints it when the pieces are not the pinned ones or some are degenerate.
+ */
+void expect(const string& name, const Pieces& got, size_t count, unsigned long long hash)
+{
+    if (got.degenerate || got.count != count || got.hash != hash)
+    {
+        failures++;
+        cout << name << ": " << got.count << " pieces (" << got.degenerate << " degenerate), hash " << hex << got.hash
+             << dec << ", expected " << count << " pieces, hash " << hex << hash << dec << "\n";
+    }
+}
+/**
+ * @brief Runs every check.
+ *
+ * @return 0 if all of them pass
+ */
+int main()
+{
+    // a region of the LOD test that split() cut along its own edge 0 -> 1, leaving a piece of two vertices
+    vector<double> xs = {-170.53203112894155, -170.48507712668919, -170.50156466452196, -170.45986291555636,
+                         -170.31557513969472, -170.27257432566103, -170.08357530553849, -170.07549971951372,
+                         -169.80738403585198};
+    vector<double> ys = {59.826412240224386, 59.870097729707489, 59.936064828403303, 59.981581157106817,
+                         59.990947052322745, 60.035936842071116, 60.089476925573258, 60.146730384318538,
+                         60.232027372121124};
+    for (bool small : {false, true})
+    {
+        Pieces p = decompose(xs, ys, small);
+        if (p.degenerate || p.count != 5)
+        {
+            failures++;
+            cout << "sliver" << (small ? " (small path)" : "") << ": " << p.count << " pieces, " << p.degenerate
+                 << " degenerate, expected 5 and 0\n";
+        }
+    }
+
+    // the corpus of adversary.cpp; backtracks-* and iterations-* had degenerate pieces before
+    const vector<tuple<string, size_t, unsigned long long>> corpus = {
+        {"backtracks-0", 220, 0xa8793ca3436fd15aULL}, {"backtracks-1", 221, 0x0e538cd25a7403eaULL},
+        {"failed-0", 156, 0x153399865fe7b038ULL},     {"failed-1", 154, 0xafdd75ed21cc7a6cULL},
+        {"iterations-0", 184, 0x2f64cc6f32c3d89bULL}, {"iterations-1", 184, 0x84ebf83e964caa50ULL},
+        {"time-0", 58, 0x9c48707fc04aa67bULL},        {"time-1", 55, 0x2482b5f4e3de9d07ULL},
+    };
+    for (auto &[name, count, hash] : corpus)
+    {
+        ifstream in("corpus/" + name + ".txt");
+        int n = 0;
+        in >> n;
+        xs.assign(n, 0);
+        ys.assign(n, 0);
+        for (int i = 0; i < n; i++)
+        {
+            in >> xs[i] >> ys[i];
+        }
+        if (!in || n < 3)
+        {
+            failures++;
+            cout << "cannot read corpus/" << name << ".txt\n";
+            continue;
+        }
+        expect(name, decompose(xs, ys, false), count, hash);
+    }
+
+    // random polygons whose pieces changed when v1 stopped being dropped, on both paths
+    const vector<tuple<int, unsigned, size_t, unsigned long long>> random = {
+        {16, 372, 8, 0x04e653483252b804ULL},
+        {16, 1110, 7, 0xf03f71af271f0ddeULL},
+        {100, 1618, 62, 0xb715b2a85de53eb0ULL},
+        {100, 1706, 58, 0x25885d3ec65ef973ULL},
+    };
+    for (auto &[n, seed, count, hash] : random)
+    {
+        random_polygon(n, seed, xs, ys);
+        for (bool small : {false, true})
+        {
+            if (small && n > SMALL_POLYGON_LIMIT)
+            {
+                continue;
+            }
+            expect("random n=" + to_string(n) + " seed " + to_string(seed) + (small ? " (small path)" : ""),
+                   decompose(xs, ys, small), count, hash);
+        }
+    }
+
+    cout << (failures ? "FAILED" : "OK") << "\n";
+    return failures ? 1 : 0;
+}